@@ -1,6 +1,7 @@
 ﻿#include "config.h"
 #include <toml++/toml.h>
 #include <fmt/core.h>
+#include <algorithm>
 
 void data::config::setup()
 {
@@ -14,6 +15,9 @@ void data::config::setup()
         _signatures.current_fishing_bite = config["signatures"]["current_fishing_bite"].value_or("");
         _signatures.localplayer_name     = config["signatures"]["localplayer_name"].value_or("");
         _signatures.localplayer_content_id = config["signatures"]["localplayer_content_id"].value_or("");
+
+        _watch.enabled     = config["watch"]["enabled"].value_or(false);
+        _watch.interval_ms = static_cast<std::uint32_t>((std::max)(config["watch"]["interval_ms"].value_or(std::int64_t{1000}), std::int64_t{50}));
     }
     catch (std::exception& ex)
     {
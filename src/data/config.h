@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 namespace data
@@ -16,16 +17,28 @@ namespace data
             std::string localplayer_content_id{};
         };
 
+        struct watch
+        {
+            bool enabled{};
+            std::uint32_t interval_ms{};
+        };
+
         void setup();
 
     private:
         signatures _signatures{};
+        watch _watch{};
 
     public:
         signatures signatures()
         {
             return _signatures;
         }
+
+        watch watch()
+        {
+            return _watch;
+        }
     };
 
     inline config config{};
@@ -1,10 +1,19 @@
 #include "game.h"
 #include "../memory/pattern.h"
 #include "config.h"
+#include "json.hpp"
 
+#include <bit>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <ranges>
 #include <xivres/installation.h>
 #include <xivres/excel.h>
+#include <xivres/util.sha1.h>
+#include <xivres/util.unicode.h>
 #include <fmt/color.h>
+#include <fmt/ranges.h>
 
 void data::game::setup_address()
 {
@@ -46,49 +55,112 @@ void data::game::setup_address()
     print(stdout, fmt::emphasis::bold | fg(fmt::color::light_green), "[+] PID: {}, 所需地址已找到\n", _process.get_pid());
 }
 
-static std::once_flag once_flag{};
-
-void data::game::setup_excel_sheet()
+namespace
 {
-    const std::wstring path = _process.get_process_path();
-    const xivres::installation game_reader(path);
+    constexpr auto excel_cache_file = "./excel_cache.json";
 
-    int inlog_index   = -1;
-    int item_id_index = -1;
+    // 多个进程会同时跑 setup_excel_sheet, 共用同一个缓存文件. 只在读写缓存文件时加锁, 哈希和解析页面不用
+    std::mutex excel_cache_mutex{};
 
-    print(stdout, fmt::emphasis::bold, "[-] PID: {}, 正在获取钓鱼的数据\n", _process.get_pid());
+    // 调用者需要持有 excel_cache_mutex
+    excel_cache::Main read_excel_cache()
+    {
+        excel_cache::Main cache{};
+        if (std::filesystem::exists(excel_cache_file) && glz::read_file_json(cache, excel_cache_file, std::string{}))
+        {
+            print(stdout, fmt::emphasis::bold | fg(fmt::color::yellow), "[!] 缓存文件 \"{}\" 已损坏, 将重新生成\n", excel_cache_file);
+            cache = {};
+        }
+
+        return cache;
+    }
 
-    const auto fish_param_sheet = game_reader.get_excel("FishParameter");
-    for (std::size_t i = 0; i < fish_param_sheet.get_exh_reader().get_pages().size(); i++)
+    using page_decoder = std::function<void(const xivres::excel::reader& sheet, std::size_t page_index, excel_cache::Page& page)>;
+
+    std::string packed_sha1(const xivres::installation& game_reader, const xivres::path_spec& path)
     {
-        for (const auto& row : fish_param_sheet.get_exd_reader(i))
+        const auto packed = game_reader.get_file_packed(path)->read_vector<std::uint8_t>();
+
+        xivres::util::hash_sha1::digest8_t digest{};
+        xivres::util::hash_sha1 hasher;
+        hasher.process_bytes(packed.data(), packed.size());
+        hasher.get_digest_bytes(digest);
+
+        return fmt::format("{:02x}", fmt::join(digest, ""));
+    }
+
+    // 返回值为解析过的页面数量, 0 代表整张表都命中了缓存
+    std::size_t sync_sheet(const xivres::installation& game_reader, const std::string& name, excel_cache::Sheet& cache, const page_decoder& decode)
+    {
+        const auto exh_sha1 = packed_sha1(game_reader, fmt::format("exd/{}.exh", name));
+
+        if (exh_sha1 == cache.exh_sha1 && !cache.pages.empty())
+        {
+            // exh没变, 页面的划分也不会变, 只需要重新解析被改过的页面
+            std::vector<std::size_t> stale_pages{};
+            for (std::size_t i = 0; i < cache.pages.size(); i++)
+            {
+                auto sha1 = packed_sha1(game_reader, cache.pages[i].path);
+                if (sha1 == cache.pages[i].sha1)
+                    continue;
+
+                cache.pages[i].sha1 = std::move(sha1);
+                stale_pages.push_back(i);
+            }
+
+            if (stale_pages.empty())
+                return 0;
+
+            const auto sheet = game_reader.get_excel(name);
+            for (const auto i : stale_pages)
+            {
+                cache.pages[i].rows.clear();
+                cache.pages[i].row_count = 0;
+                decode(sheet, i, cache.pages[i]);
+            }
+
+            return stale_pages.size();
+        }
+
+        const auto sheet = game_reader.get_excel(name);
+        const auto& exh = sheet.get_exh_reader();
+
+        cache.exh_sha1 = exh_sha1;
+        cache.pages.clear();
+        for (std::size_t i = 0; i < exh.get_pages().size(); i++)
+        {
+            const auto path = exh.get_exd_path(exh.get_pages()[i], sheet.get_language());
+
+            auto& page = cache.pages.emplace_back();
+            page.path  = path.text();
+            page.sha1  = packed_sha1(game_reader, path);
+            decode(sheet, i, page);
+        }
+
+        return cache.pages.size();
+    }
+
+    void decode_fish_parameter_page(const xivres::excel::reader& sheet, std::size_t page_index, excel_cache::Page& page)
+    {
+        std::vector<xivres::excel::cell_type> types{};
+        for (const auto& column : sheet.get_exh_reader().get_columns())
+        {
+            types.emplace_back(column.Type);
+        }
+
+        const auto item_it = std::ranges::find(types, xivres::excel::cell_type::Int32);
+        if (item_it == types.end())
+            throw std::exception("找不到 itemid 的index");
+
+        const auto inlog_it = std::ranges::find(types, xivres::excel::cell_type::PackedBool1);
+        if (inlog_it == types.end())
+            throw std::exception("找不到 inlog 的index");
+
+        const auto item_id_index = std::distance(types.begin(), item_it);
+        const auto inlog_index   = std::distance(types.begin(), inlog_it);
+
+        for (const auto& row : sheet.get_exd_reader(page_index))
         {
-            std::call_once(once_flag,
-                           [row, &inlog_index, &item_id_index]
-                           {
-                               std::vector<xivres::excel::cell_type> types{};
-
-                               for (const auto& j : row[0])
-                               {
-                                   types.emplace_back(j.Type);
-                               }
-
-                               if (auto item_it = std::ranges::find(types, xivres::excel::cell_type::Int32); item_it != types.end())
-                               {
-                                   item_id_index = std::distance(types.begin(), item_it);
-                               }
-
-                               if (auto inlog_it = std::ranges::find(types, xivres::excel::cell_type::PackedBool1); inlog_it != types.end())
-                               {
-                                   inlog_index = std::distance(types.begin(), inlog_it);
-                               }
-
-                               if (inlog_index == -1)
-                                   throw std::exception("找不到 inlog 的index");
-                               if (item_id_index == -1)
-                                   throw std::exception("找不到 itemid 的index");
-                           });
-            
             for (const auto& subrow : row)
             {
                 const auto item_id = subrow[item_id_index].int32;
@@ -97,17 +169,14 @@ void data::game::setup_excel_sheet()
                 if (item_id == 0 || !in_log)
                     continue;
 
-                _fishlog_map[row.row_id()] = item_id;
+                page.rows[row.row_id()] = item_id;
             }
         }
     }
 
-    print(stdout, fmt::emphasis::bold, "[-] PID: {}, 正在获取刺鱼的数据\n", _process.get_pid());
-
-    const auto spear_fish_sheet = game_reader.get_excel("SpearfishingItem");
-    for (std::size_t i = 0; i < spear_fish_sheet.get_exh_reader().get_pages().size(); i++)
+    void decode_spearfishing_item_page(const xivres::excel::reader& sheet, std::size_t page_index, excel_cache::Page& page)
     {
-        for (const auto& row : spear_fish_sheet.get_exd_reader(i))
+        for (const auto& row : sheet.get_exd_reader(page_index))
         {
             for (const auto& subrow : row)
             {
@@ -115,71 +184,146 @@ void data::game::setup_excel_sheet()
                 if (item_id == 0)
                     continue;
 
-                _spear_fishlog_map[row.row_id()] = item_id;
+                page.rows[row.row_id()] = item_id;
             }
         }
     }
 
-    const auto spearfishing_notebook = game_reader.get_excel("SpearfishingNotebook");
-    for (std::size_t i = 0; i < spearfishing_notebook.get_exh_reader().get_pages().size(); i++)
+    void decode_spearfishing_notebook_page(const xivres::excel::reader& sheet, std::size_t page_index, excel_cache::Page& page)
     {
-        for (const auto& _ : spearfishing_notebook.get_exd_reader(i))
+        for (const auto& _ : sheet.get_exd_reader(page_index))
         {
-            _spearfish_notebook_size++;
+            page.row_count++;
         }
     }
-
-    print(stdout, fmt::emphasis::bold | fg(fmt::color::light_green), "[+] PID: {}, 已获取所需csv文件的内容\n", _process.get_pid());
 }
 
-std::vector<std::uint32_t> data::game::get_unlocked_fishes()
+void data::game::setup_excel_sheet()
 {
-    print(stdout, fmt::emphasis::bold, "[-] PID: {}, 导出数据中...\n", _process.get_pid());
+    const std::wstring path = _process.get_process_path();
+    const xivres::installation game_reader(path);
+    const auto cache_key = xivres::util::unicode::convert<std::string>(path);
 
-    std::vector<std::uint32_t> result{};
-    for (const auto& [param_id, item_id] : _fishlog_map)
+    excel_cache::Installation installation_cache{};
     {
-        if (!is_fish_unlocked(param_id))
-            continue;
+        const std::lock_guard lock(excel_cache_mutex);
+        if (auto cache = read_excel_cache(); cache.installations.contains(cache_key))
+            installation_cache = std::move(cache.installations[cache_key]);
+    }
+
+    print(stdout, fmt::emphasis::bold, "[-] PID: {}, 正在获取钓鱼的数据\n", _process.get_pid());
+    auto decoded_pages = sync_sheet(game_reader, "FishParameter", installation_cache.fish_parameter, decode_fish_parameter_page);
 
-        result.push_back(item_id);
+    print(stdout, fmt::emphasis::bold, "[-] PID: {}, 正在获取刺鱼的数据\n", _process.get_pid());
+    decoded_pages += sync_sheet(game_reader, "SpearfishingItem", installation_cache.spearfishing_item, decode_spearfishing_item_page);
+    decoded_pages += sync_sheet(game_reader, "SpearfishingNotebook", installation_cache.spearfishing_notebook, decode_spearfishing_notebook_page);
+
+    for (const auto& page : installation_cache.fish_parameter.pages)
+    {
+        _fishlog_map.insert(page.rows.begin(), page.rows.end());
     }
 
-    for (const auto& [param_id, item_id] : _spear_fishlog_map)
+    for (const auto& page : installation_cache.spearfishing_item.pages)
     {
-        if (!is_spear_fish_unlocked(param_id))
-            continue;
+        _spear_fishlog_map.insert(page.rows.begin(), page.rows.end());
+    }
 
-        result.push_back(item_id);
+    for (const auto& page : installation_cache.spearfishing_notebook.pages)
+    {
+        _spearfish_notebook_size += page.row_count;
     }
-    return result;
+
+    if (decoded_pages == 0)
+    {
+        print(stdout, fmt::emphasis::bold | fg(fmt::color::light_green), "[+] PID: {}, 游戏数据没有变化, 使用缓存\n", _process.get_pid());
+        return;
+    }
+
+    {
+        // 解析期间别的进程可能已经写过缓存文件, 重新读一遍再合并, 不覆盖其他安装目录的缓存
+        const std::lock_guard lock(excel_cache_mutex);
+
+        auto cache = read_excel_cache();
+        cache.installations[cache_key] = std::move(installation_cache);
+
+        if (glz::write_file_json(cache, excel_cache_file, std::string{}))
+        {
+            print(stdout, fmt::emphasis::bold | fg(fmt::color::yellow), "[!] 写入缓存文件 \"{}\" 时出错\n", excel_cache_file);
+        }
+    }
+
+    print(stdout, fmt::emphasis::bold | fg(fmt::color::light_green), "[+] PID: {}, 已获取所需csv文件的内容 (解析了 {} 个页面)\n", _process.get_pid(), decoded_pages);
+}
+
+std::vector<std::uint32_t> data::game::get_unlocked_fishes()
+{
+    print(stdout, fmt::emphasis::bold, "[-] PID: {}, 导出数据中...\n", _process.get_pid());
+
+    return get_newly_unlocked_fishes({}, read_fishlog());
 }
 
-bool data::game::is_fish_unlocked(std::uint32_t fish_id)
+namespace
 {
-    const auto offset = fish_id / 8;
-    const auto bit    = static_cast<std::uint8_t>(fish_id) % 8;
+    constexpr std::uint32_t spear_fishlog_offset = 20000;
 
-    const auto addr = _process.read<std::uint8_t>(_fishlog_address + offset);
-    if (!addr.has_value())
-        throw std::exception("无法获取钓鱼日志. 可能因为没有管理员运行或者杀软误报");
+    std::size_t fishlog_size(const std::unordered_map<std::uint32_t, std::uint32_t>& fishlog_map, std::uint32_t offset)
+    {
+        std::uint32_t max_id = 0;
+        for (const auto& param_id : fishlog_map | std::views::keys)
+        {
+            max_id = (std::max)(max_id, param_id);
+        }
+
+        return max_id < offset ? 0 : (max_id - offset) / 8 + 1;
+    }
+
+    // 两份日志逐个64位字异或, 没变化的字直接跳过, 只对变化的位查表
+    void collect_new_bits(const std::vector<std::uint64_t>& previous,
+                          const std::vector<std::uint64_t>& current,
+                          const std::unordered_map<std::uint32_t, std::uint32_t>& fishlog_map,
+                          std::uint32_t offset,
+                          std::vector<std::uint32_t>& result)
+    {
+        for (std::size_t i = 0; i < current.size(); i++)
+        {
+            const auto old_word = i < previous.size() ? previous[i] : 0;
+            auto new_bits       = (old_word ^ current[i]) & current[i];
+            if (new_bits == 0)
+                continue;
 
-    return ((*addr >> bit) & 1) == 1;
+            for (; new_bits; new_bits &= new_bits - 1)
+            {
+                const auto param_id = static_cast<std::uint32_t>(i * 64 + std::countr_zero(new_bits)) + offset;
+                if (const auto it = fishlog_map.find(param_id); it != fishlog_map.end())
+                    result.push_back(it->second);
+            }
+        }
+    }
 }
 
-bool data::game::is_spear_fish_unlocked(std::uint32_t fish_id)
+data::game::fishlog_snapshot data::game::read_fishlog()
 {
-    constexpr int spear_fishlog_offset = 20000;
+    fishlog_snapshot snapshot{};
 
-    fish_id -= spear_fishlog_offset;
-    const auto offset = fish_id / 8;
-    const auto bit    = static_cast<std::uint8_t>(fish_id) % 8;
+    auto fishlog = _process.read_vector<std::uint64_t>(_fishlog_address, fishlog_size(_fishlog_map, 0));
+    if (!fishlog.has_value())
+        throw std::exception("无法获取钓鱼日志. 可能因为没有管理员运行或者杀软误报");
+    snapshot.fishlog = std::move(*fishlog);
 
-    const auto addr = _process.read<std::uint8_t>(_spear_fishlog_address + offset);
-    if (!addr.has_value())
+    auto spear_fishlog = _process.read_vector<std::uint64_t>(_spear_fishlog_address, fishlog_size(_spear_fishlog_map, spear_fishlog_offset));
+    if (!spear_fishlog.has_value())
         throw std::exception("无法获取刺鱼日志. 可能因为没有管理员运行或者杀软误报");
+    snapshot.spear_fishlog = std::move(*spear_fishlog);
+
+    return snapshot;
+}
 
-    return ((*addr >> bit) & 1) == 1;
+std::vector<std::uint32_t> data::game::get_newly_unlocked_fishes(const fishlog_snapshot& previous, const fishlog_snapshot& current) const
+{
+    std::vector<std::uint32_t> result{};
+    collect_new_bits(previous.fishlog, current.fishlog, _fishlog_map, 0, result);
+    collect_new_bits(previous.spear_fishlog, current.spear_fishlog, _spear_fishlog_map, spear_fishlog_offset, result);
+    return result;
 }
 
 bool data::game::is_valid()
@@ -9,6 +9,13 @@ namespace data
     class game
     {
     public:
+        // 按小端的64位字存放, 第 n 位对应 param id 为 n 的鱼 (刺鱼要减去 20000)
+        struct fishlog_snapshot
+        {
+            std::vector<std::uint64_t> fishlog{};
+            std::vector<std::uint64_t> spear_fishlog{};
+        };
+
         explicit game(const mem::process& process)
         {
             _process = process;
@@ -18,14 +25,13 @@ namespace data
         void setup_excel_sheet();
 
         [[nodiscard]] std::vector<std::uint32_t> get_unlocked_fishes();
+        [[nodiscard]] fishlog_snapshot read_fishlog();
+        [[nodiscard]] std::vector<std::uint32_t> get_newly_unlocked_fishes(const fishlog_snapshot& previous, const fishlog_snapshot& current) const;
         [[nodiscard]] bool is_valid();
         std::string get_localplayer_name();
         std::uint64_t get_localplayer_content_id();
 
     private:
-        [[nodiscard]] bool is_fish_unlocked(std::uint32_t fish_id);
-        [[nodiscard]] bool is_spear_fish_unlocked(std::uint32_t fish_id);
-
         std::uintptr_t _fishlog_address{};
         std::uintptr_t _spear_fishlog_address{};
         std::uintptr_t _object_table{};
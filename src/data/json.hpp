@@ -3,6 +3,8 @@
 #include <glaze/json.hpp>
 #include <glaze/core/macros.hpp>
 
+#include <map>
+
 namespace pastry_fish
 {
     struct Main
@@ -11,4 +13,52 @@ namespace pastry_fish
 
         GLZ_LOCAL_META(Main, completed);
     };
+
+    // 常驻模式下每解锁一条鱼就往 events_*.jsonl 里追加一行
+    struct Event
+    {
+        std::int64_t time;
+        std::uint32_t item_id;
+
+        GLZ_LOCAL_META(Event, time, item_id);
+    };
+}
+
+namespace excel_cache
+{
+    // 一个exd页面, sha1 是sqpack里压缩数据的哈希, 不用解压就能判断有没有被补丁改过
+    struct Page
+    {
+        std::string path;
+        std::string sha1;
+        std::map<std::uint32_t, std::uint32_t> rows;
+        std::size_t row_count{};
+
+        GLZ_LOCAL_META(Page, path, sha1, rows, row_count);
+    };
+
+    struct Sheet
+    {
+        std::string exh_sha1;
+        std::vector<Page> pages;
+
+        GLZ_LOCAL_META(Sheet, exh_sha1, pages);
+    };
+
+    struct Installation
+    {
+        Sheet fish_parameter;
+        Sheet spearfishing_item;
+        Sheet spearfishing_notebook;
+
+        GLZ_LOCAL_META(Installation, fish_parameter, spearfishing_item, spearfishing_notebook);
+    };
+
+    // 以游戏路径为key, 国服和国际服可以同时开着
+    struct Main
+    {
+        std::map<std::string, Installation> installations;
+
+        GLZ_LOCAL_META(Main, installations);
+    };
 }
@@ -3,9 +3,11 @@
 #include "data/game.h"
 #include "data/json.hpp"
 
+#include <fstream>
 #include <iostream>
 #include <fmt/color.h>
 #include <fmt/core.h>
+#include <fmt/ranges.h>
 #include <magic_enum.hpp>
 #include <stacktrace>
 
@@ -98,7 +100,98 @@ static std::vector<DWORD> get_ffxiv_processes()
     return result;
 }
 
-static void dump_data(pastry_fish::Main& pastry_fish_struct, const DWORD pid)
+static void wait_for_localplayer(data::game& data, const DWORD pid)
+{
+    std::once_flag flag{};
+
+    while (!data.is_valid())
+    {
+        std::call_once(flag,
+                       [pid]
+                       {
+                           print(stdout, fmt::emphasis::bold | fg(fmt::color::red), "[x] PID: {}, 检测不到本地玩家, 数据将会在检测到后导出\n", pid);
+                       });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+}
+
+static void write_result(data::game& data, const pastry_fish::Main& pastry_fish_struct)
+{
+    const auto name = data.get_localplayer_name();
+    const auto content_id = data.get_localplayer_content_id();
+    const auto file_name = fmt::format("result_{}_{:x}.json", name, content_id);
+    if (glz::write_file_json(pastry_fish_struct, file_name, std::string {}))
+    {
+        throw std::runtime_error(fmt::format("写入文件时出错"));
+    }
+
+    print(stdout, fmt::emphasis::bold | fg(fmt::color::light_green), "[+] {0} 的数据已写入到 {1} 里.\n", name, file_name);
+}
+
+static void append_events(data::game& data, const std::vector<std::uint32_t>& item_ids)
+{
+    const auto name = data.get_localplayer_name();
+    const auto file_name = fmt::format("events_{}_{:x}.jsonl", name, data.get_localplayer_content_id());
+    const auto now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::ofstream file(file_name, std::ios::app | std::ios::binary);
+    for (const auto item_id : item_ids)
+    {
+        std::string line{};
+        glz::write_json(pastry_fish::Event{now, item_id}, line);
+        file << line << '\n';
+    }
+
+    if (!file)
+        throw std::runtime_error(fmt::format("写入文件 {} 时出错", file_name));
+
+    print(stdout, fmt::emphasis::bold | fg(fmt::color::light_green), "[+] {0} 新解锁了 {1} 条鱼: {2}\n", name, item_ids.size(), fmt::join(item_ids, ", "));
+}
+
+// 常驻模式: 进程句柄, 地址和excel数据都留着, 只定时比较两次日志的差异
+static void watch_data(data::game& data, pastry_fish::Main& pastry_fish_struct, const DWORD pid)
+{
+    const auto interval = std::chrono::milliseconds(data::config.watch().interval_ms);
+
+    auto content_id = data.get_localplayer_content_id();
+    auto previous = data.read_fishlog();
+
+    print(stdout, fmt::emphasis::bold, "[-] PID: {}, 常驻模式已开启, 每 {} 毫秒检查一次\n", pid, interval.count());
+
+    while (true)
+    {
+        std::this_thread::sleep_for(interval);
+
+        // 切换角色或者读条的时候没有本地玩家
+        if (!data.is_valid())
+            continue;
+
+        auto current = data.read_fishlog();
+
+        if (const auto current_content_id = data.get_localplayer_content_id(); current_content_id != content_id)
+        {
+            content_id = current_content_id;
+            pastry_fish_struct.completed = data.get_newly_unlocked_fishes({}, current);
+            previous = std::move(current);
+
+            write_result(data, pastry_fish_struct);
+            continue;
+        }
+
+        const auto unlocked = data.get_newly_unlocked_fishes(previous, current);
+        previous = std::move(current);
+
+        if (unlocked.empty())
+            continue;
+
+        append_events(data, unlocked);
+        pastry_fish_struct.completed.insert(pastry_fish_struct.completed.end(), unlocked.begin(), unlocked.end());
+        write_result(data, pastry_fish_struct);
+    }
+}
+
+static void dump_data(pastry_fish::Main pastry_fish_struct, const DWORD pid)
 {
     const auto process = mem::process(pid);
 
@@ -109,29 +202,13 @@ static void dump_data(pastry_fish::Main& pastry_fish_struct, const DWORD pid)
         data.setup_excel_sheet();
         data.setup_address();
 
-        std::once_flag flag{};
-
-        while (!data.is_valid())
-        {
-            std::call_once(flag,
-                           [pid]
-                           {
-                               print(stdout, fmt::emphasis::bold | fg(fmt::color::red), "[x] PID: {}, 检测不到本地玩家, 数据将会在检测到后导出\n", pid);
-                           });
+        wait_for_localplayer(data, pid);
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        }
         pastry_fish_struct.completed = data.get_unlocked_fishes();
+        write_result(data, pastry_fish_struct);
 
-        const auto name = data.get_localplayer_name();
-        const auto content_id = data.get_localplayer_content_id();
-        const auto file_name = fmt::format("result_{}_{:x}.json", name, content_id);
-        if (glz::write_file_json(pastry_fish_struct, file_name, std::string {}))
-        {
-            throw std::runtime_error(fmt::format("写入文件时出错"));
-        }
-
-        print(stdout, fmt::emphasis::bold | fg(fmt::color::light_green), "[+] {0} 的数据已写入到 {1} 里.\n", name, file_name);
+        if (data::config.watch().enabled)
+            watch_data(data, pastry_fish_struct, pid);
     }
     catch (std::exception& ex)
     {
@@ -169,18 +246,36 @@ int main()
 
         pastry_fish::Main pastry_fish_struct{};
 
-        glz::pool pool;
-
-        for (const DWORD& pid : processes)
+        if (data::config.watch().enabled)
         {
-            pool.emplace_back(
-            [&]
+            // 常驻模式下dump_data不会返回, 每个进程都要有自己的线程, 不然超过核心数的进程永远轮不到
+            std::vector<std::jthread> threads{};
+            threads.reserve(processes.size());
+
+            for (const DWORD& pid : processes)
             {
-                dump_data(pastry_fish_struct, pid);
-            });
+                threads.emplace_back(
+                [&]
+                {
+                    dump_data(pastry_fish_struct, pid);
+                });
+            }
         }
+        else
+        {
+            glz::pool pool;
 
-        pool.wait();
+            for (const DWORD& pid : processes)
+            {
+                pool.emplace_back(
+                [&]
+                {
+                    dump_data(pastry_fish_struct, pid);
+                });
+            }
+
+            pool.wait();
+        }
 
         print(stdout, fmt::emphasis::bold | fg(fmt::color::light_green), "[+] 完毕, 5秒后退出程序.\n");
 
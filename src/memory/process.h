@@ -58,6 +58,17 @@ namespace mem
             return res;
         }
 
+        // 读取 size 个字节, 结尾不足一个 T 的部分补零
+        template <typename T>
+        std::optional<std::vector<T>> read_vector(std::uintptr_t address, std::size_t size)
+        {
+            std::vector<T> res((size + sizeof(T) - 1) / sizeof(T));
+            if (size && !read_impl(address, reinterpret_cast<void*>(res.data()), size))
+                return std::nullopt;
+
+            return res;
+        }
+
         template <typename T>
         bool write(std::uintptr_t address, T value)
         {
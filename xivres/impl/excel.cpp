@@ -4,10 +4,11 @@
 #include "../include/xivres/sqpack.reader.h"
 #include "../include/xivres/unpacked_stream.h"
 
+using namespace xivres::literals;
 using namespace xivres::util;
 
 xivres::excel::exl::reader::reader(const xivres::installation& installation)
-	: reader(*installation.get_file("exd/root.exl")) {
+	: reader(*installation.get_file("exd/root.exl"_xivpath)) {
 }
 
 xivres::excel::exl::reader::reader(const stream& strm) {
@@ -74,9 +75,10 @@ xivres::path_spec xivres::excel::exh::reader::get_exd_path(const page& page, gam
 		return std::format("exd/{}_{}_{}.exd", m_name, *page.StartId, game_language_code(language));
 }
 
-xivres::excel::exd::row::reader::reader(std::span<const char> fixedData, std::span<const char> fullData, const std::vector<exh::column>& columns)
+xivres::excel::exd::row::reader::reader(std::span<const char> fixedData, std::span<const char> fullData, std::shared_ptr<const void> dataOwner, const std::vector<exh::column>& columns)
 	: m_fixedData(fixedData)
 	, m_fullData(fullData)
+	, m_dataOwner(std::move(dataOwner))
 	, m_cells(columns.size())
 	, Columns(columns) {
 }
@@ -98,7 +100,8 @@ xivres::excel::cell& xivres::excel::exd::row::reader::resolve_cell(size_t index)
 		case cell_type::String: {
 			BE<uint32_t> stringOffset;
 			std::copy_n(&m_fixedData[columnDefinition.Offset], 4, reinterpret_cast<char*>(&stringOffset));
-			column.String.escaped(&m_fullData[m_fixedData.size() + stringOffset]);
+			const auto data = m_fullData.subspan(m_fixedData.size() + stringOffset);
+			column.borrow_string(std::string_view(data.data(), std::ranges::find(data, 0) - data.begin()), m_dataOwner);
 			break;
 		}
 
@@ -159,21 +162,21 @@ xivres::excel::exd::row::buffer::buffer()
 xivres::excel::exd::row::buffer::buffer(uint32_t rowId, const exh::reader& exhReader, const stream& strm, std::streamoff offset)
 	: m_rowId(rowId)
 	, m_rowHeader(strm.read_fully<row::header>(offset))
-	, m_buffer(strm.read_vector<char>(offset + sizeof m_rowHeader, m_rowHeader.DataSize)) {
+	, m_buffer(std::make_shared<const std::vector<char>>(strm.read_vector<char>(offset + sizeof m_rowHeader, m_rowHeader.DataSize))) {
 	m_rows.reserve(m_rowHeader.SubRowCount);
 
 	if (exhReader.header().Variant == variant::Level2) {
-		const auto fixedData = std::span(m_buffer).subspan(0, exhReader.header().FixedDataSize);
+		const auto fixedData = std::span(*m_buffer).subspan(0, exhReader.header().FixedDataSize);
 
 		for (size_t i = 0, i_ = m_rowHeader.SubRowCount; i < i_; i++)
-			m_rows.emplace_back(fixedData, std::span(m_buffer), exhReader.get_columns());
+			m_rows.emplace_back(fixedData, std::span(*m_buffer), m_buffer, exhReader.get_columns());
 
 	} else if (exhReader.header().Variant == variant::Level3) {
 		for (size_t i = 0, i_ = m_rowHeader.SubRowCount; i < i_; ++i) {
 			const auto baseOffset = i * (size_t() + 2 + exhReader.header().FixedDataSize);
-			const auto fixedData = std::span(m_buffer).subspan(2 + baseOffset, exhReader.header().FixedDataSize);
+			const auto fixedData = std::span(*m_buffer).subspan(2 + baseOffset, exhReader.header().FixedDataSize);
 
-			m_rows.emplace_back(fixedData, std::span(m_buffer), exhReader.get_columns());
+			m_rows.emplace_back(fixedData, std::span(*m_buffer), m_buffer, exhReader.get_columns());
 		}
 
 	} else {
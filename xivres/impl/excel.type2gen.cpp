@@ -1,5 +1,6 @@
 #include "../include/xivres/excel.type2gen.h"
 #include "../include/xivres/util.span_cast.h"
+#include "../include/xivres/util.thread_pool.h"
 
 using namespace xivres::util;
 
@@ -60,19 +61,211 @@ void xivres::excel::type2gen::add_language(game_language language) {
 		Languages.insert(it, language);
 }
 
-const std::vector<xivres::excel::cell>& xivres::excel::type2gen::get_row(uint32_t id, game_language language) const {
-	return Data.at(id).at(language);
+std::vector<uint32_t> xivres::excel::type2gen::row_ids() const {
+	std::vector<uint32_t> res;
+	res.reserve(m_rowIndex.size());
+	for (const auto id : m_rowIndex | std::views::keys)
+		res.push_back(id);
+	return res;
+}
+
+bool xivres::excel::type2gen::has_row(uint32_t id, game_language language) const {
+	const auto pSlot = find_slot(id);
+	return pSlot && state_of(*pSlot, language) != row_state::Absent;
+}
+
+std::vector<xivres::excel::cell> xivres::excel::type2gen::get_row(uint32_t id, game_language language) const {
+	const auto pSlot = find_slot(id);
+	if (!pSlot)
+		throw std::out_of_range(std::format("row {} does not exist", id));
+
+	switch (state_of(*pSlot, language)) {
+		case row_state::Absent:
+			throw std::out_of_range(std::format("row {} does not exist for language {}", id, static_cast<int>(language)));
+		case row_state::Empty:
+			return {};
+		case row_state::Present:
+			break;
+	}
+
+	const auto& table = m_tables.at(language);
+	std::vector<cell> row;
+	row.reserve(Columns.size());
+	for (const auto& column : table.Cells)
+		row.emplace_back(column[*pSlot]);
+	return row;
+}
+
+const xivres::excel::cell& xivres::excel::type2gen::get_cell(uint32_t id, game_language language, size_t columnIndex) const {
+	const auto pSlot = find_slot(id);
+	if (!pSlot || state_of(*pSlot, language) != row_state::Present)
+		throw std::out_of_range(std::format("row {} has no data for language {}", id, static_cast<int>(language)));
+	return m_tables.at(language).Cells.at(columnIndex)[*pSlot];
 }
 
 void xivres::excel::type2gen::set_row(uint32_t id, game_language language, std::vector<cell> row, bool replace) {
 	if (!row.empty() && row.size() != Columns.size())
 		throw std::invalid_argument(std::format("bad column data (expected {} columns, got {} columns)", Columns.size(), row.size()));
-	auto& target = Data[id][language];
-	if (target.empty() || replace)
-		target = std::move(row);
+
+	const auto slot = find_or_add_slot(id);
+	auto& table = m_tables[language];
+	if (table.States.size() <= slot)
+		table.States.resize(m_rowIndex.size(), row_state::Absent);
+
+	auto& state = table.States[slot];
+	if (state == row_state::Present && !replace)
+		return;
+
+	if (row.empty()) {
+		state = row_state::Empty;
+		return;
+	}
+
+	table.Cells.resize(Columns.size());
+	for (size_t i = 0; i < row.size(); ++i) {
+		auto& column = table.Cells[i];
+		if (column.size() <= slot)
+			column.resize(m_rowIndex.size());
+
+		// Strings borrowed from a source row would otherwise keep that row's buffer alive for as long as the generator.
+		if (Columns[i].Type == cell_type::String)
+			static_cast<void>(row[i].owned_string());
+		column[slot] = std::move(row[i]);
+	}
+	state = row_state::Present;
+}
+
+const uint32_t* xivres::excel::type2gen::find_slot(uint32_t id) const {
+	const auto it = std::ranges::lower_bound(m_rowIndex, id, {}, &std::pair<uint32_t, uint32_t>::first);
+	return it != m_rowIndex.end() && it->first == id ? &it->second : nullptr;
+}
+
+uint32_t xivres::excel::type2gen::find_or_add_slot(uint32_t id) {
+	// Rows are usually added in ascending order, in which case this appends.
+	const auto it = std::ranges::lower_bound(m_rowIndex, id, {}, &std::pair<uint32_t, uint32_t>::first);
+	if (it != m_rowIndex.end() && it->first == id)
+		return it->second;
+
+	const auto slot = static_cast<uint32_t>(m_rowIndex.size());
+	m_rowIndex.emplace(it, id, slot);
+	return slot;
+}
+
+xivres::excel::type2gen::row_state xivres::excel::type2gen::state_of(uint32_t slot, game_language language) const {
+	const auto it = m_tables.find(language);
+	if (it == m_tables.end() || it->second.States.size() <= slot)
+		return row_state::Absent;
+	return it->second.States[slot];
+}
+
+std::optional<std::pair<xivres::path_spec, std::vector<char>>> xivres::excel::type2gen::compile_page(const exh::page& page, std::span<const std::pair<uint32_t, uint32_t>> rowIndex, game_language language) const {
+	const auto fixedDataOffset = sizeof(exd::row::header);
+	const auto variableDataOffset = fixedDataOffset + FixedDataSize;
+
+	std::vector<std::pair<uint32_t, std::vector<char>>> rows;
+	rows.reserve(rowIndex.size());
+
+	// String offsets are relative to the row that contains them, so identical strings can only share storage within a row.
+	std::vector<std::pair<std::string_view, uint32_t>> rowStrings;
+
+	for (const auto& [id, slot] : rowIndex) {
+		auto sourceLanguage = language;
+		if (state_of(slot, sourceLanguage) == row_state::Absent) {
+			sourceLanguage = game_language::Unspecified;
+			for (const auto lang : FillMissingLanguageFrom) {
+				if (state_of(slot, lang) != row_state::Absent) {
+					sourceLanguage = lang;
+					break;
+				}
+			}
+			if (sourceLanguage == game_language::Unspecified)
+				continue;
+		}
+
+		if (state_of(slot, sourceLanguage) != row_state::Present)
+			continue;
+
+		const auto& table = m_tables.at(sourceLanguage);
+		std::vector<char> row(sizeof(exd::row::header) + FixedDataSize);
+		rowStrings.clear();
+
+		for (size_t i = 0; i < Columns.size(); ++i) {
+			const auto& column = table.Cells[i][slot];
+			const auto& columnDefinition = Columns[i];
+			size_t validSize = 0;
+			switch (columnDefinition.Type) {
+				case cell_type::String:
+				{
+					const auto escaped = column.string().escaped();
+					auto it = std::ranges::find(rowStrings, escaped, &std::pair<std::string_view, uint32_t>::first);
+					if (it == rowStrings.end()) {
+						it = rowStrings.emplace(rowStrings.end(), escaped, static_cast<uint32_t>(row.size() - variableDataOffset));
+						row.insert(row.end(), escaped.begin(), escaped.end());
+						row.push_back(0);
+					}
+					const auto stringOffset = BE<uint32_t>(it->second);
+					std::copy_n(reinterpret_cast<const char*>(&stringOffset), 4, &row[fixedDataOffset + columnDefinition.Offset]);
+					break;
+				}
+
+				case cell_type::Bool:
+				case cell_type::Int8:
+				case cell_type::UInt8:
+					validSize = 1;
+					break;
+
+				case cell_type::Int16:
+				case cell_type::UInt16:
+					validSize = 2;
+					break;
+
+				case cell_type::Int32:
+				case cell_type::UInt32:
+				case cell_type::Float32:
+					validSize = 4;
+					break;
+
+				case cell_type::Int64:
+				case cell_type::UInt64:
+					validSize = 8;
+					break;
+
+				case cell_type::PackedBool0:
+				case cell_type::PackedBool1:
+				case cell_type::PackedBool2:
+				case cell_type::PackedBool3:
+				case cell_type::PackedBool4:
+				case cell_type::PackedBool5:
+				case cell_type::PackedBool6:
+				case cell_type::PackedBool7:
+					if (column.boolean)
+						row[fixedDataOffset + columnDefinition.Offset] |= (1 << (static_cast<int>(column.Type) - static_cast<int>(cell_type::PackedBool0)));
+					else
+						row[fixedDataOffset + columnDefinition.Offset] &= ~((1 << (static_cast<int>(column.Type) - static_cast<int>(cell_type::PackedBool0))));
+					break;
+			}
+			if (validSize) {
+				const auto target = std::span(row).subspan(fixedDataOffset + columnDefinition.Offset, validSize);
+				std::copy_n(&column.Buffer[0], validSize, &target[0]);
+				// ReSharper disable once CppUseRangeAlgorithm
+				std::reverse(target.begin(), target.end());
+			}
+		}
+		row.resize(xivres::align<size_t>(row.size(), 4));
+
+		auto& rowHeader = *reinterpret_cast<exd::row::header*>(&row[0]);
+		rowHeader.DataSize = static_cast<uint32_t>(row.size() - sizeof rowHeader);
+		rowHeader.SubRowCount = 1;
+
+		rows.emplace_back(id, std::move(row));
+	}
+
+	if (rows.empty())
+		return std::nullopt;
+	return flush(page.StartId, rows, language);
 }
 
-std::pair<xivres::path_spec, std::vector<char>> xivres::excel::type2gen::flush(uint32_t startId, const std::map<uint32_t, std::vector<char>>& rows, game_language language) const {
+std::pair<xivres::path_spec, std::vector<char>> xivres::excel::type2gen::flush(uint32_t startId, const std::vector<std::pair<uint32_t, std::vector<char>>>& rows, game_language language) const {
 	exd::header exdHeader;
 	const auto exdHeaderSpan = span_cast<char>(1, &exdHeader);
 	memcpy(exdHeader.Signature, exd::header::Signature_Value, 4);
@@ -105,123 +298,62 @@ std::pair<xivres::path_spec, std::vector<char>> xivres::excel::type2gen::flush(u
 		return std::make_pair(path_spec(std::format("exd/{}_{}.exd", Name, startId)), std::move(exdFile));
 }
 
-std::map<xivres::path_spec, std::vector<char>, xivres::path_spec::FullPathComparator> xivres::excel::type2gen::compile() {
+std::map<xivres::path_spec, std::vector<char>, xivres::path_spec::FullPathComparator> xivres::excel::type2gen::compile() const {
 	std::map<path_spec, std::vector<char>, path_spec::FullPathComparator> result;
+	if (m_rowIndex.empty())
+		return {};
 
-	std::vector<std::pair<exh::page, std::vector<uint32_t>>> pages;
-	for (const auto id : Data | std::views::keys) {
-		if (pages.empty()) {
-			pages.emplace_back();
-		} else if (pages.back().second.size() == DivideUnit || DivideAtIds.contains(id)) {
-			pages.back().first.RowCountWithSkip = pages.back().second.back() - pages.back().second.front() + 1;
-			pages.emplace_back();
+	const auto rowIndex = std::span(m_rowIndex);
+	std::vector<std::pair<exh::page, std::span<const std::pair<uint32_t, uint32_t>>>> pages;
+	const auto add_page = [&](size_t from, size_t to) {
+		auto& page = pages.emplace_back();
+		page.first.StartId = rowIndex[from].first;
+		page.first.RowCountWithSkip = rowIndex[to - 1].first - rowIndex[from].first + 1;
+		page.second = rowIndex.subspan(from, to - from);
+	};
+	size_t pageBegin = 0;
+	for (size_t i = 1; i < rowIndex.size(); ++i) {
+		if (i - pageBegin == DivideUnit || DivideAtIds.contains(rowIndex[i].first)) {
+			add_page(pageBegin, i);
+			pageBegin = i;
 		}
-
-		if (pages.back().second.empty())
-			pages.back().first.StartId = id;
-		pages.back().second.push_back(id);
 	}
-	if (pages.empty())
-		return {};
-
-	pages.back().first.RowCountWithSkip = pages.back().second.back() - pages.back().second.front() + 1;
-
-	for (const auto& page : pages) {
-		for (const auto language : Languages) {
-			std::map<uint32_t, std::vector<char>> rows;
-			for (const auto id : page.second) {
-				std::vector<char> row(sizeof(exd::row::header) + FixedDataSize);
-
-				const auto fixedDataOffset = sizeof(exd::row::header);
-				const auto variableDataOffset = fixedDataOffset + FixedDataSize;
-
-				auto sourceLanguage = language;
-				auto& rowSet = Data[id];
-				if (!rowSet.contains(sourceLanguage)) {
-					sourceLanguage = game_language::Unspecified;
-					for (auto lang : FillMissingLanguageFrom) {
-						if (!rowSet.contains(lang)) {
-							sourceLanguage = lang;
-							break;
-						}
-					}
-					if (sourceLanguage == game_language::Unspecified)
-						continue;
-				}
+	add_page(pageBegin, rowIndex.size());
 
-				auto& columns = rowSet[sourceLanguage];
-				if (columns.empty())
+	// Escaped forms of strings are cached lazily inside each cell; resolve them up front, one column per task,
+	// so that pages filling in from the same language never race on the same cell.
+	{
+		util::thread_pool::task_waiter<size_t> waiter;
+		for (const auto& table : m_tables | std::views::values) {
+			for (size_t i = 0; i < table.Cells.size(); ++i) {
+				if (Columns[i].Type != cell_type::String)
 					continue;
 
-				for (size_t i = 0; i < columns.size(); ++i) {
-					auto& column = columns[i];
-					const auto& columnDefinition = Columns[i];
-					switch (columnDefinition.Type) {
-						case cell_type::String:
-						{
-							const auto stringOffset = BE<uint32_t>(static_cast<uint32_t>(row.size() - variableDataOffset));
-							std::copy_n(reinterpret_cast<const char*>(&stringOffset), 4, &row[fixedDataOffset + columnDefinition.Offset]);
-							row.insert(row.end(), column.String.escaped().begin(), column.String.escaped().end());
-							row.push_back(0);
-							column.ValidSize = 0;
-							break;
-						}
-
-						case cell_type::Bool:
-						case cell_type::Int8:
-						case cell_type::UInt8:
-							column.ValidSize = 1;
-							break;
-
-						case cell_type::Int16:
-						case cell_type::UInt16:
-							column.ValidSize = 2;
-							break;
-
-						case cell_type::Int32:
-						case cell_type::UInt32:
-						case cell_type::Float32:
-							column.ValidSize = 4;
-							break;
-
-						case cell_type::Int64:
-						case cell_type::UInt64:
-							column.ValidSize = 8;
-							break;
-
-						case cell_type::PackedBool0:
-						case cell_type::PackedBool1:
-						case cell_type::PackedBool2:
-						case cell_type::PackedBool3:
-						case cell_type::PackedBool4:
-						case cell_type::PackedBool5:
-						case cell_type::PackedBool6:
-						case cell_type::PackedBool7:
-							column.ValidSize = 0;
-							if (column.boolean)
-								row[fixedDataOffset + columnDefinition.Offset] |= (1 << (static_cast<int>(column.Type) - static_cast<int>(cell_type::PackedBool0)));
-							else
-								row[fixedDataOffset + columnDefinition.Offset] &= ~((1 << (static_cast<int>(column.Type) - static_cast<int>(cell_type::PackedBool0))));
-							break;
-					}
-					if (column.ValidSize) {
-						const auto target = std::span(row).subspan(fixedDataOffset + columnDefinition.Offset, column.ValidSize);
-						std::copy_n(&column.Buffer[0], column.ValidSize, &target[0]);
-						// ReSharper disable once CppUseRangeAlgorithm
-						std::reverse(target.begin(), target.end());
+				waiter.submit([&cells = table.Cells[i]](util::thread_pool::base_task& task) {
+					for (const auto& column : cells) {
+						task.throw_if_cancelled();
+						static_cast<void>(column.string());
 					}
-				}
-				row.resize(xivres::align<size_t>(row.size(), 4));
-
-				auto& rowHeader = *reinterpret_cast<exd::row::header*>(&row[0]);
-				rowHeader.DataSize = static_cast<uint32_t>(row.size() - sizeof rowHeader);
-				rowHeader.SubRowCount = 1;
+					return cells.size();
+				});
+			}
+		}
+		while (waiter.get()) {}
+	}
 
-				rows.emplace(id, std::move(row));
+	{
+		util::thread_pool::task_waiter<std::optional<std::pair<path_spec, std::vector<char>>>> waiter;
+		for (const auto& [page, rows] : pages) {
+			for (const auto language : Languages) {
+				waiter.submit([this, &page, rows, language](util::thread_pool::base_task& task) {
+					task.throw_if_cancelled();
+					return compile_page(page, rows, language);
+				});
 			}
-			if (rows.empty())
-				continue;
-			result.emplace(flush(page.first.StartId, rows, language));
+		}
+		while (auto compiled = waiter.get()) {
+			if (*compiled)
+				result.emplace(std::move(**compiled));
 		}
 	}
 
@@ -236,7 +368,7 @@ std::map<xivres::path_spec, std::vector<char>, xivres::path_spec::FullPathCompar
 		exhHeader.LanguageCount = static_cast<uint16_t>(Languages.size());
 		exhHeader.ReadStrategy = ReadStrategy;
 		exhHeader.Variant = variant::Level2;
-		exhHeader.RowCountWithoutSkip = static_cast<uint32_t>(Data.size());
+		exhHeader.RowCountWithoutSkip = static_cast<uint32_t>(m_rowIndex.size());
 
 		const auto columnSpan = span_cast<char>(Columns);
 		std::vector<exh::page> paginations;
@@ -157,6 +157,7 @@ void xivres::fontdata::stream::add_kerning(const kerning_entry& entry, bool cumu
 	}
 
 	m_fthd.KerningEntryCount = m_knhd.EntryCount = static_cast<uint32_t>(m_kerningEntries.size());
+	m_lookup.Ready = false;
 }
 
 void xivres::fontdata::stream::add_kerning(char32_t l, char32_t r, int rightOffset, bool cumulative) {
@@ -174,6 +175,8 @@ void xivres::fontdata::stream::add_glyph(const glyph_entry& entry) {
 	if (entry.TextureIndex >= 256)
 		throw std::invalid_argument("Texture Index cannot be bigger than 255.");
 
+	m_lookup.Ready = false;
+
 	auto it = m_fontTableEntries.end();
 
 	if (m_fontTableEntries.empty() || m_fontTableEntries.back() < entry)
@@ -211,6 +214,8 @@ void xivres::fontdata::stream::add_glyph(char32_t c, uint16_t textureIndex, uint
 	if (textureIndex >= 256)
 		throw std::invalid_argument("Texture Index cannot be bigger than 255.");
 
+	m_lookup.Ready = false;
+
 	const auto val = util::unicode::u32_to_u8uint32(c);
 
 	auto it = std::lower_bound(m_fontTableEntries.begin(), m_fontTableEntries.end(), val, [](const glyph_entry& l, uint32_t r) {
@@ -266,20 +271,63 @@ void xivres::fontdata::stream::reserve_kernings(size_t count) {
 	m_kerningEntries.reserve(count);
 }
 
+const xivres::fontdata::stream::lookup_cache& xivres::fontdata::stream::get_lookup() const {
+	if (m_lookup.Ready)
+		return m_lookup;
+
+	const auto lock = std::lock_guard(m_lookup.Mtx);
+	if (m_lookup.Ready)
+		return m_lookup;
+
+	m_lookup.Bmp.clear();
+	m_lookup.Bmp.resize(0x10000);
+	// Iterate backwards so that the first of the repeated space entries wins, as lower_bound would.
+	for (auto i = m_fontTableEntries.size(); i-- > 0;) {
+		if (const auto c = m_fontTableEntries[i].codepoint(); c < 0x10000)
+			m_lookup.Bmp[c] = static_cast<uint32_t>(i + 1);
+	}
+
+	size_t kerningSlotCount = 16;
+	while (kerningSlotCount < m_kerningEntries.size() * 2)
+		kerningSlotCount <<= 1;
+	m_lookup.Kerning.clear();
+	m_lookup.Kerning.resize(kerningSlotCount);
+	m_lookup.KerningMask = kerningSlotCount - 1;
+	for (const auto& entry : m_kerningEntries) {
+		if (!entry.RightOffset)
+			continue;
+
+		const auto key = lookup_cache::make_kerning_key(entry.LeftUtf8Value, entry.RightUtf8Value);
+		auto slot = lookup_cache::hash_kerning_key(key) & m_lookup.KerningMask;
+		while (m_lookup.Kerning[slot].RightOffset && m_lookup.Kerning[slot].Key != key)
+			slot = (slot + 1) & m_lookup.KerningMask;
+		if (!m_lookup.Kerning[slot].RightOffset)
+			m_lookup.Kerning[slot] = {key, entry.RightOffset};
+	}
+
+	m_lookup.Ready = true;
+	return m_lookup;
+}
+
 int xivres::fontdata::stream::get_kerning(char32_t l, char32_t r) const {
-	const auto pair = std::make_pair(util::unicode::u32_to_u8uint32(l), util::unicode::u32_to_u8uint32(r));
-	const auto it = std::lower_bound(m_kerningEntries.begin(), m_kerningEntries.end(), pair,
-		[](const kerning_entry& l, const std::pair<uint32_t, uint32_t>& r) {
-		if (l.LeftUtf8Value == r.first)
-			return l.RightUtf8Value < r.second;
-		return l.LeftUtf8Value < r.first;
-	});
-	if (it == m_kerningEntries.end() || it->LeftUtf8Value != pair.first || it->RightUtf8Value != pair.second)
+	if (m_kerningEntries.empty())
 		return 0;
-	return it->RightOffset;
+
+	const auto& lookup = get_lookup();
+	const auto key = lookup_cache::make_kerning_key(util::unicode::u32_to_u8uint32(l), util::unicode::u32_to_u8uint32(r));
+	for (auto slot = lookup_cache::hash_kerning_key(key) & lookup.KerningMask; lookup.Kerning[slot].RightOffset; slot = (slot + 1) & lookup.KerningMask) {
+		if (lookup.Kerning[slot].Key == key)
+			return lookup.Kerning[slot].RightOffset;
+	}
+	return 0;
 }
 
 const xivres::fontdata::glyph_entry* xivres::fontdata::stream::get_glyph(char32_t c) const {
+	if (c < 0x10000) {
+		const auto index = get_lookup().Bmp[c];
+		return index ? &m_fontTableEntries[index - 1] : nullptr;
+	}
+
 	const auto val = util::unicode::u32_to_u8uint32(c);
 	const auto it = std::lower_bound(m_fontTableEntries.begin(), m_fontTableEntries.end(), val,
 		[](const glyph_entry& l, uint32_t r) {
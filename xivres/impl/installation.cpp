@@ -34,6 +34,14 @@ std::shared_ptr<xivres::unpacked_stream> xivres::installation::get_file(const pa
 	return std::make_shared<unpacked_stream>(get_sqpack(pathSpec).packed_at(pathSpec), obfuscatedHeaderRewrite);
 }
 
+std::shared_ptr<xivres::packed_stream> xivres::installation::get_file_packed(const hashed_path& path) const {
+	return get_sqpack(path.PackId).packed_at(path);
+}
+
+std::shared_ptr<xivres::unpacked_stream> xivres::installation::get_file(const hashed_path& path, std::span<uint8_t> obfuscatedHeaderRewrite) const {
+	return std::make_shared<unpacked_stream>(get_sqpack(path.PackId).packed_at(path), obfuscatedHeaderRewrite);
+}
+
 std::vector<uint32_t> xivres::installation::get_sqpack_ids() const {
 	std::vector<uint32_t> res;
 	res.reserve(m_readers.size());
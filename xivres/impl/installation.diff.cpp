@@ -0,0 +1,196 @@
+#include "../include/xivres/installation.diff.h"
+
+#include <ranges>
+
+#include "../include/xivres/util.thread_pool.h"
+
+namespace {
+	struct keyed_entry {
+		uint32_t PathHash;
+		uint32_t NameHash;
+		uint32_t FullPathHash;
+		std::string_view Text;
+		const xivres::sqpack::reader::entry_info* Entry;
+
+		// Text is not part of the key, since only one side may have it for the same file; it only tells apart entries
+		// whose hashes collide.
+		[[nodiscard]] auto key() const {
+			return std::tie(PathHash, NameHash, FullPathHash);
+		}
+
+		[[nodiscard]] auto sort_key() const {
+			return std::tie(PathHash, NameHash, FullPathHash, Text);
+		}
+	};
+
+	std::vector<keyed_entry> sorted_entries(const xivres::sqpack::reader* reader) {
+		std::vector<keyed_entry> res;
+		if (!reader)
+			return res;
+
+		res.reserve(reader->Entries.size());
+		for (const auto& entry : reader->Entries) {
+			const auto& spec = entry.PathSpec;
+			res.emplace_back(keyed_entry{spec.path_hash(), spec.name_hash(), spec.full_path_hash(), spec.text(), &entry});
+		}
+
+		// Deduplicated entries share a locator, and the reader pairs up the path hash pairs and full path hashes of those
+		// without text in no particular order. Only the set of each is known, so they are paired up again in sorted
+		// order; the same group on both sides then gets the same keys, whatever order either reader paired them in.
+		// Reader entries are sorted by locator, so a group is a run of them.
+		for (auto runBegin = res.begin(); runBegin != res.end();) {
+			auto runEnd = std::next(runBegin);
+			while (runEnd != res.end() && runEnd->Entry->Locator == runBegin->Entry->Locator)
+				++runEnd;
+
+			std::vector<keyed_entry*> textless;
+			for (auto it = runBegin; it != runEnd; ++it) {
+				if (it->Text.empty())
+					textless.emplace_back(&*it);
+			}
+
+			if (textless.size() > 1) {
+				std::vector<std::pair<uint32_t, uint32_t>> pairHashes;
+				std::vector<uint32_t> fullHashes;
+				for (const auto entry : textless) {
+					pairHashes.emplace_back(entry->PathHash, entry->NameHash);
+					fullHashes.emplace_back(entry->FullPathHash);
+				}
+				std::ranges::sort(pairHashes);
+				std::ranges::sort(fullHashes);
+				for (size_t i = 0; i < textless.size(); ++i)
+					std::tie(textless[i]->PathHash, textless[i]->NameHash, textless[i]->FullPathHash) = std::tie(pairHashes[i].first, pairHashes[i].second, fullHashes[i]);
+			}
+
+			runBegin = runEnd;
+		}
+
+		std::ranges::sort(res, {}, &keyed_entry::sort_key);
+		return res;
+	}
+
+	bool packed_bytes_equal(const xivres::sqpack::reader& oldReader, const xivres::sqpack::reader::entry_info& oldEntry, const xivres::sqpack::reader& newReader, const xivres::sqpack::reader::entry_info& newEntry) {
+		using namespace xivres;
+
+		static constexpr size_t ChunkSize = 262144;
+
+		const auto& oldStream = *oldReader.Data.at(oldEntry.Locator.DatFileIndex).Stream;
+		const auto& newStream = *newReader.Data.at(newEntry.Locator.DatFileIndex).Stream;
+		const auto oldOffset = static_cast<std::streamoff>(oldEntry.Locator.offset());
+		const auto newOffset = static_cast<std::streamoff>(newEntry.Locator.offset());
+
+		const auto oldHeader = oldStream.read_fully<packed::file_header>(oldOffset);
+		const auto newHeader = newStream.read_fully<packed::file_header>(newOffset);
+
+		// AllocatedSpaceUnitCount only tells how much room the entry was given, so it is left out.
+		if (oldHeader.HeaderSize != newHeader.HeaderSize
+			|| oldHeader.Type != newHeader.Type
+			|| oldHeader.DecompressedSize != newHeader.DecompressedSize
+			|| oldHeader.OccupiedSpaceUnitCount != newHeader.OccupiedSpaceUnitCount
+			|| oldHeader.BlockCountOrVersion != newHeader.BlockCountOrVersion)
+			return false;
+
+		const auto size = (std::min)({oldHeader.occupied_size(), oldEntry.Allocation, newEntry.Allocation});
+		std::vector<uint8_t> oldBuf, newBuf;
+		for (uint64_t pos = sizeof oldHeader; pos < size; pos += ChunkSize) {
+			const auto length = static_cast<size_t>((std::min<uint64_t>)(ChunkSize, size - pos));
+			oldBuf.resize(length);
+			newBuf.resize(length);
+			util::thread_pool::pool::current().release_working_status([&] {
+				oldStream.read_fully(oldOffset + static_cast<std::streamoff>(pos), std::span(oldBuf));
+				newStream.read_fully(newOffset + static_cast<std::streamoff>(pos), std::span(newBuf));
+			});
+			if (oldBuf != newBuf)
+				return false;
+		}
+
+		return true;
+	}
+}
+
+xivres::installation_diff::installation_diff(const installation& oldInstallation, const installation& newInstallation, bool compareUnmovedEntries) {
+	std::vector<uint32_t> packIds;
+	{
+		const auto oldIds = oldInstallation.get_sqpack_ids();
+		const auto newIds = newInstallation.get_sqpack_ids();
+		std::ranges::set_union(oldIds, newIds, std::back_inserter(packIds));
+	}
+
+	struct pack_changes {
+		std::vector<change> Added;
+		std::vector<change> Removed;
+		std::vector<change> Modified;
+	};
+	std::vector<pack_changes> perPack(packIds.size());
+	util::thread_pool::task_waiter<size_t> waiter;
+	for (size_t i = 0; i < packIds.size(); ++i) {
+		waiter.submit([&oldInstallation, &newInstallation, compareUnmovedEntries, packId = packIds[i], &res = perPack[i]](util::thread_pool::base_task& task) {
+			const auto oldIds = oldInstallation.get_sqpack_ids();
+			const auto newIds = newInstallation.get_sqpack_ids();
+			const auto oldReader = std::ranges::binary_search(oldIds, packId) ? &oldInstallation.get_sqpack(packId) : nullptr;
+			const auto newReader = std::ranges::binary_search(newIds, packId) ? &newInstallation.get_sqpack(packId) : nullptr;
+			const auto oldEntries = sorted_entries(oldReader);
+			const auto newEntries = sorted_entries(newReader);
+
+			const auto compare = [&](const keyed_entry& oldKeyed, const keyed_entry& newKeyed) {
+				const auto& oldEntry = *oldKeyed.Entry;
+				const auto& newEntry = *newKeyed.Entry;
+				const auto unmoved = oldEntry.Locator == newEntry.Locator && oldEntry.Allocation == newEntry.Allocation;
+				if ((!unmoved || compareUnmovedEntries) && !packed_bytes_equal(*oldReader, oldEntry, *newReader, newEntry))
+					res.Modified.emplace_back(change{newEntry.PathSpec, packId, &oldEntry, &newEntry});
+			};
+
+			auto oldIt = oldEntries.begin();
+			auto newIt = newEntries.begin();
+			while (oldIt != oldEntries.end() || newIt != newEntries.end()) {
+				task.throw_if_cancelled();
+
+				if (newIt == newEntries.end() || (oldIt != oldEntries.end() && oldIt->key() < newIt->key())) {
+					res.Removed.emplace_back(change{oldIt->Entry->PathSpec, packId, oldIt->Entry, nullptr});
+					++oldIt;
+
+				} else if (oldIt == oldEntries.end() || newIt->key() < oldIt->key()) {
+					res.Added.emplace_back(change{newIt->Entry->PathSpec, packId, nullptr, newIt->Entry});
+					++newIt;
+
+				} else {
+					auto oldEnd = std::next(oldIt);
+					while (oldEnd != oldEntries.end() && oldEnd->key() == oldIt->key())
+						++oldEnd;
+					auto newEnd = std::next(newIt);
+					while (newEnd != newEntries.end() && newEnd->key() == newIt->key())
+						++newEnd;
+
+					// Synonyms are paired up by text where both sides have the same one, and in order otherwise.
+					std::vector<const keyed_entry*> oldUnmatched, newUnmatched;
+					while (oldIt != oldEnd || newIt != newEnd) {
+						if (newIt == newEnd || (oldIt != oldEnd && oldIt->Text < newIt->Text))
+							oldUnmatched.emplace_back(&*oldIt++);
+						else if (oldIt == oldEnd || newIt->Text < oldIt->Text)
+							newUnmatched.emplace_back(&*newIt++);
+						else
+							compare(*oldIt++, *newIt++);
+					}
+
+					for (size_t i = 0; i < (std::max)(oldUnmatched.size(), newUnmatched.size()); ++i) {
+						if (i >= newUnmatched.size())
+							res.Removed.emplace_back(change{oldUnmatched[i]->Entry->PathSpec, packId, oldUnmatched[i]->Entry, nullptr});
+						else if (i >= oldUnmatched.size())
+							res.Added.emplace_back(change{newUnmatched[i]->Entry->PathSpec, packId, nullptr, newUnmatched[i]->Entry});
+						else
+							compare(*oldUnmatched[i], *newUnmatched[i]);
+					}
+				}
+			}
+
+			return res.Added.size() + res.Removed.size() + res.Modified.size();
+		});
+	}
+	waiter.wait_all();
+
+	for (auto& part : perPack) {
+		Added.insert(Added.end(), std::make_move_iterator(part.Added.begin()), std::make_move_iterator(part.Added.end()));
+		Removed.insert(Removed.end(), std::make_move_iterator(part.Removed.begin()), std::make_move_iterator(part.Removed.end()));
+		Modified.insert(Modified.end(), std::make_move_iterator(part.Modified.begin()), std::make_move_iterator(part.Modified.end()));
+	}
+}
@@ -1,6 +1,8 @@
 #include "../include/xivres/packed_stream.h"
 #include "../include/xivres/unpacked_stream.h"
 
+#include <cmath>
+
 xivres::unpacked_stream xivres::packed_stream::get_unpacked(std::span<uint8_t> obfuscatedHeaderRewrite) const {
 	return {std::static_pointer_cast<const packed_stream>(shared_from_this()), obfuscatedHeaderRewrite};
 }
@@ -9,8 +11,65 @@ std::unique_ptr<xivres::unpacked_stream> xivres::packed_stream::make_unpacked_pt
 	return std::make_unique<unpacked_stream>(std::static_pointer_cast<const packed_stream>(shared_from_this()), obfuscatedHeaderRewrite);
 }
 
-void xivres::compressing_packer::preload() {
-	m_preloadedStream.emplace(m_stream);
+int xivres::compression_level_for(const xivres::path_spec& pathSpec, packed::type packedType, compression_preference preference) {
+	const auto& text = pathSpec.text();
+	std::string extension;
+	if (const auto dot = text.find_last_of('.'); dot != std::string::npos && (text.find_last_of('/') == std::string::npos || dot > text.find_last_of('/')))
+		extension = text.substr(dot + 1);
+	for (auto& c : extension) {
+		if ('A' <= c && c <= 'Z')
+			c += 'a' - 'A';
+	}
+
+	// Sound data is mostly Ogg Vorbis or ADPCM, and texture data is mostly block compressed;
+	// neither gains much from the slower deflate levels.
+	const auto mostlyPrecompressed = extension == "scd" || packedType == packed::type::texture;
+
+	switch (preference) {
+		case compression_preference::fastest:
+			return Z_BEST_SPEED;
+		case compression_preference::balanced:
+			return mostlyPrecompressed ? Z_BEST_SPEED : Z_DEFAULT_COMPRESSION;
+		case compression_preference::smallest:
+			return mostlyPrecompressed ? Z_DEFAULT_COMPRESSION : Z_BEST_COMPRESSION;
+	}
+	return Z_BEST_COMPRESSION;
+}
+
+// Decides whether deflating would be a waste of time, from the byte histogram and the rate of repeated 4-byte sequences.
+static bool is_likely_incompressible(std::span<const uint8_t> data) {
+	constexpr double MinEntropyBitsPerByte = 7.9;
+	constexpr size_t MaxRepeatsPer1024 = 16;
+	constexpr size_t SampleStride = 4;
+
+	if (data.size() < 256)
+		return false;
+
+	uint32_t histogram[256]{};
+	for (const auto c : data)
+		histogram[c]++;
+
+	auto entropy = 0.;
+	for (const auto count : histogram) {
+		if (count) {
+			const auto p = static_cast<double>(count) / static_cast<double>(data.size());
+			entropy -= p * std::log2(p);
+		}
+	}
+	if (entropy < MinEntropyBitsPerByte)
+		return false;
+
+	// High order-0 entropy can still hide long repeats that deflate would find.
+	uint32_t recent[4096]{};
+	size_t repeats = 0, samples = 0;
+	for (size_t i = 0; i + 4 <= data.size(); i += SampleStride, ++samples) {
+		uint32_t v;
+		memcpy(&v, &data[i], 4);
+		auto& slot = recent[(v * 2654435761U) >> 20];
+		repeats += slot == v ? 1 : 0;
+		slot = v;
+	}
+	return repeats * 1024 < samples * MaxRepeatsPer1024;
 }
 
 void xivres::compressing_packer::compress_block(uint32_t offset, uint32_t length, block_data_t& blockData) const {
@@ -29,7 +88,7 @@ void xivres::compressing_packer::compress_block(uint32_t offset, uint32_t length
 
 	blockData.DecompressedSize = static_cast<uint32_t>(length);
 	blockData.AllZero = std::ranges::all_of(buffer, [](const auto& c) { return !c; });
-	if (compression_level()) {
+	if (compression_level() && (blockData.AllZero || !is_likely_incompressible(buffer))) {
 		auto deflater = util::zlib_deflater::pooled();
 		if (!deflater || !deflater->is(compression_level(), Z_DEFLATED, -15))
 			deflater.emplace(compression_level(), Z_DEFLATED, -15);
@@ -41,3 +100,42 @@ void xivres::compressing_packer::compress_block(uint32_t offset, uint32_t length
 	}
 	blockData.Data = std::move(buffer);
 }
+
+bool xivres::compressing_packer::compress_blocks(std::span<const std::pair<uint32_t, uint32_t>> blocks, const std::function<void(size_t index, block_data_t& blockData)>& emit) {
+	if (!multithreaded()) {
+		for (size_t i = 0; i < blocks.size() && !cancelled(); ++i) {
+			block_data_t blockData;
+			compress_block(blocks[i].first, blocks[i].second, blockData);
+			if (!cancelled())
+				emit(i, blockData);
+		}
+		return !cancelled();
+	}
+
+	auto& pool = util::thread_pool::pool::current();
+	const auto ringSize = (std::max<size_t>)(8, 4 * pool.concurrency());
+	std::vector<block_data_t> ring(ringSize);
+	std::vector<char> ready(ringSize);
+
+	util::thread_pool::task_waiter<size_t> waiter(pool);
+	for (size_t nextToSubmit = 0, nextToEmit = 0; nextToEmit < blocks.size() && !cancelled();) {
+		for (; nextToSubmit < blocks.size() && nextToSubmit < nextToEmit + ringSize; ++nextToSubmit) {
+			waiter.submit([this, index = nextToSubmit, block = blocks[nextToSubmit], &blockData = ring[nextToSubmit % ringSize]](util::thread_pool::base_task& task) {
+				if (task.cancelled())
+					cancel();
+				if (!cancelled())
+					compress_block(block.first, block.second, blockData);
+				return index;
+			});
+		}
+
+		ready[*waiter.get() % ringSize] = true;
+		for (; nextToEmit < nextToSubmit && ready[nextToEmit % ringSize] && !cancelled(); ++nextToEmit) {
+			emit(nextToEmit, ring[nextToEmit % ringSize]);
+			ring[nextToEmit % ringSize] = {};
+			ready[nextToEmit % ringSize] = false;
+		}
+	}
+
+	return !cancelled();
+}
@@ -227,96 +227,57 @@ std::streamsize xivres::model_passthrough_packer::translate_read(std::streamoff
 std::unique_ptr<xivres::stream> xivres::model_compressing_packer::pack() {
 	const auto unpackedHeader = unpacked().read_fully<model::header>(0);
 
-	std::vector<std::vector<block_data_t>> blockDataList;
-	blockDataList.reserve(11);
-
-	if (!multithreaded()) {
-		auto baseFileOffset = static_cast<uint32_t>(sizeof unpackedHeader);
-		const auto generateSet = [&](const uint32_t setSize) {
-			const auto alignedBlock = align<uint32_t, uint16_t>(setSize, packed::MaxBlockDataSize);
-
-			auto& setBlockDataList = blockDataList.emplace_back();
-			setBlockDataList.resize(alignedBlock.Count);
-
-			alignedBlock.iterate_chunks_breakable([&](size_t blockIndex, uint32_t offset, uint32_t length) {
-				compress_block(offset, length, setBlockDataList[blockIndex]);
-				return !cancelled();
-			}, baseFileOffset);
-
-			baseFileOffset += setSize;
-		};
-
-		generateSet(unpackedHeader.StackSize);
-		generateSet(unpackedHeader.RuntimeSize);
-
-		for (size_t i = 0; i < 3; i++) {
-			generateSet(unpackedHeader.VertexSize[i]);
-			generateSet(unpackedHeader.IndexOffset[i] - unpackedHeader.VertexOffset[i] - unpackedHeader.VertexSize[i]);
-			generateSet(unpackedHeader.IndexSize[i]);
-		}
-
-	} else {
-		util::thread_pool::task_waiter waiter;
-		preload();
+	// Sets in the order they appear in the file; see packed::model_block_locator::EntryIndexMap.
+	uint32_t setSizes[11]{unpackedHeader.StackSize, unpackedHeader.RuntimeSize};
+	for (size_t i = 0; i < 3; i++) {
+		setSizes[2 + i * 3] = unpackedHeader.VertexSize[i];
+		setSizes[3 + i * 3] = unpackedHeader.IndexOffset[i] - unpackedHeader.VertexOffset[i] - unpackedHeader.VertexSize[i];
+		setSizes[4 + i * 3] = unpackedHeader.IndexSize[i];
+	}
 
+	std::vector<std::pair<uint32_t, uint32_t>> blocks;
+	{
 		auto baseFileOffset = static_cast<uint32_t>(sizeof unpackedHeader);
-		const auto generateSet = [&](const uint32_t setSize) {
-			const auto alignedBlock = align<uint32_t, uint16_t>(setSize, packed::MaxBlockDataSize);
-
-			auto& setBlockDataList = blockDataList.emplace_back();
-			setBlockDataList.resize(alignedBlock.Count);
-
-			alignedBlock.iterate_chunks_breakable([&](size_t blockIndex, uint32_t offset, uint32_t length) {
-				waiter.submit([this, offset, length, &blockData = setBlockDataList[blockIndex]](auto& task) {
-					if (task.cancelled())
-						cancel();
-					if (!cancelled())
-						compress_block(offset, length, blockData);
-				});
-
-				return !cancelled();
+		for (const auto setSize : setSizes) {
+			align<uint32_t, uint16_t>(setSize, packed::MaxBlockDataSize).iterate_chunks([&](size_t, uint32_t offset, uint32_t length) {
+				blocks.emplace_back(offset, length);
 			}, baseFileOffset);
-
 			baseFileOffset += setSize;
-		};
-
-		generateSet(unpackedHeader.StackSize);
-		generateSet(unpackedHeader.RuntimeSize);
-
-		for (size_t i = 0; i < 3; i++) {
-			generateSet(unpackedHeader.VertexSize[i]);
-			generateSet(unpackedHeader.IndexOffset[i] - unpackedHeader.VertexOffset[i] - unpackedHeader.VertexSize[i]);
-			generateSet(unpackedHeader.IndexSize[i]);
 		}
-
-		if (!cancelled())
-			waiter.wait_all();
 	}
 
-	if (cancelled())
-		return nullptr;
-
-	size_t totalBlockCount = 0, entryBodyLength = 0;
-	for (const auto& set : blockDataList) {
-		for (const auto& blockData : set) {
-			totalBlockCount++;
-			entryBodyLength += align(sizeof(packed::block_header) + blockData.Data.size());
-		}
-	}
 	const auto entryHeaderLength = static_cast<uint16_t>(align(0
 		+ sizeof(packed::file_header)
 		+ sizeof(packed::model_block_locator)
-		+ sizeof(uint16_t) * totalBlockCount
+		+ sizeof(uint16_t) * blocks.size()
 	));
 
-	std::vector<uint8_t> result(entryHeaderLength + entryBodyLength);
+	// Blocks are appended as soon as they are compressed, so only a bounded number of blocks is held besides the result.
+	std::vector<uint8_t> result(entryHeaderLength);
+	std::vector<uint16_t> paddedBlockSizes(blocks.size());
+	const auto completed = compress_blocks(blocks, [&](size_t index, block_data_t& blockData) {
+		const auto alloc = static_cast<uint16_t>(align(sizeof(packed::block_header) + blockData.Data.size()));
+		const auto blockOffset = result.size();
+		result.resize(blockOffset + alloc);
+
+		auto& header = *reinterpret_cast<packed::block_header*>(&result[blockOffset]);
+		header.HeaderSize = sizeof(packed::block_header);
+		header.Version = 0;
+		header.CompressedSize = blockData.Deflated ? static_cast<uint32_t>(blockData.Data.size()) : packed::block_header::CompressedSizeNotCompressed;
+		header.DecompressedSize = blocks[index].second;
+		std::ranges::copy(blockData.Data, result.begin() + static_cast<std::ptrdiff_t>(blockOffset + sizeof header));
+
+		paddedBlockSizes[index] = alloc;
+	});
+	if (!completed)
+		return nullptr;
 
 	auto& entryHeader = *reinterpret_cast<packed::file_header*>(&result[0]);
 	entryHeader.Type = packed::type::model;
 	entryHeader.DecompressedSize = static_cast<uint32_t>(unpacked().size());
 	entryHeader.BlockCountOrVersion = static_cast<uint32_t>(unpackedHeader.Version);
 	entryHeader.HeaderSize = entryHeaderLength;
-	entryHeader.set_space_units(entryBodyLength);
+	entryHeader.set_space_units(result.size() - entryHeaderLength);
 
 	auto& modelHeader = *reinterpret_cast<packed::model_block_locator*>(&entryHeader + 1);
 	modelHeader.VertexDeclarationCount = unpackedHeader.VertexDeclarationCount;
@@ -325,91 +286,24 @@ std::unique_ptr<xivres::stream> xivres::model_compressing_packer::pack() {
 	modelHeader.EnableIndexBufferStreaming = unpackedHeader.EnableIndexBufferStreaming;
 	modelHeader.EnableEdgeGeometry = unpackedHeader.EnableEdgeGeometry;
 
-	const auto paddedBlockSizes = util::span_cast<uint16_t>(result, sizeof entryHeader + sizeof modelHeader, totalBlockCount);
+	std::ranges::copy(paddedBlockSizes, util::span_cast<uint16_t>(result, sizeof entryHeader + sizeof modelHeader, paddedBlockSizes.size()).begin());
 
-	{
-		uint16_t totalBlockIndex = 0;
-		uint32_t nextBlockOffset = 0;
-
-		auto resultDataPtr = result.begin() + entryHeaderLength;
-		auto baseFileOffset = static_cast<uint32_t>(sizeof unpackedHeader);
-		const auto generateSet = [&](size_t setIndex, const uint32_t size) {
-			const auto alignedDecompressedSize = align(size).Alloc;
-			const auto alignedBlock = align<uint32_t, uint16_t>(size, packed::MaxBlockDataSize);
-			const auto firstBlockOffset = size ? nextBlockOffset : 0;
-			const auto firstBlockIndex = static_cast<uint16_t>(totalBlockIndex);
-
-			alignedBlock.iterate_chunks([&](size_t blockIndex, uint32_t offset, uint32_t length) {
-				if (cancelled())
-					return false;
-				auto& blockData = blockDataList[setIndex][blockIndex];
-
-				auto& header = *reinterpret_cast<packed::block_header*>(&*resultDataPtr);
-				header.HeaderSize = sizeof(packed::block_header);
-				header.Version = 0;
-				header.CompressedSize = blockData.Deflated ? static_cast<uint32_t>(blockData.Data.size()) : packed::block_header::CompressedSizeNotCompressed;
-				header.DecompressedSize = static_cast<uint32_t>(length);
-
-				std::ranges::copy(blockData.Data, resultDataPtr + sizeof header);
-
-				const auto alloc = static_cast<uint16_t>(align(sizeof header + blockData.Data.size()));
-
-				paddedBlockSizes[totalBlockIndex++] = alloc;
-				nextBlockOffset += alloc;
-
-				resultDataPtr += alloc;
+	uint16_t totalBlockIndex = 0;
+	uint32_t nextBlockOffset = 0;
+	for (size_t setIndex = 0; setIndex < std::size(setSizes); ++setIndex) {
+		const auto size = setSizes[setIndex];
+		const auto alignedBlock = align<uint32_t, uint16_t>(size, packed::MaxBlockDataSize);
+		const auto firstBlockOffset = size ? nextBlockOffset : 0;
+		const auto firstBlockIndex = totalBlockIndex;
 
-				std::vector<uint8_t>().swap(blockData.Data);
-				return true;
-			}, baseFileOffset);
+		for (uint16_t i = 0; i < alignedBlock.Count; ++i)
+			nextBlockOffset += paddedBlockSizes[totalBlockIndex++];
 
-			const auto chunkSize = size ? nextBlockOffset - firstBlockOffset : 0;
-			baseFileOffset += size;
-
-			return std::make_tuple(
-				alignedDecompressedSize,
-				alignedBlock.Count,
-				firstBlockOffset,
-				firstBlockIndex,
-				chunkSize
-			);
-		};
-
-		size_t setIndexCounter = 0;
-		std::tie(modelHeader.AlignedDecompressedSizes.Stack,
-			modelHeader.BlockCount.Stack,
-			modelHeader.FirstBlockOffsets.Stack,
-			modelHeader.FirstBlockIndices.Stack,
-			modelHeader.ChunkSizes.Stack) = generateSet(setIndexCounter++, unpackedHeader.StackSize);
-
-		std::tie(modelHeader.AlignedDecompressedSizes.Runtime,
-			modelHeader.BlockCount.Runtime,
-			modelHeader.FirstBlockOffsets.Runtime,
-			modelHeader.FirstBlockIndices.Runtime,
-			modelHeader.ChunkSizes.Runtime) = generateSet(setIndexCounter++, unpackedHeader.RuntimeSize);
-
-		for (size_t i = 0; i < 3; i++) {
-			if (cancelled())
-				return {};
-
-			std::tie(modelHeader.AlignedDecompressedSizes.Vertex[i],
-				modelHeader.BlockCount.Vertex[i],
-				modelHeader.FirstBlockOffsets.Vertex[i],
-				modelHeader.FirstBlockIndices.Vertex[i],
-				modelHeader.ChunkSizes.Vertex[i]) = generateSet(setIndexCounter++, unpackedHeader.VertexSize[i]);
-
-			std::tie(modelHeader.AlignedDecompressedSizes.EdgeGeometryVertex[i],
-				modelHeader.BlockCount.EdgeGeometryVertex[i],
-				modelHeader.FirstBlockOffsets.EdgeGeometryVertex[i],
-				modelHeader.FirstBlockIndices.EdgeGeometryVertex[i],
-				modelHeader.ChunkSizes.EdgeGeometryVertex[i]) = generateSet(setIndexCounter++, unpackedHeader.IndexOffset[i] - unpackedHeader.VertexOffset[i] - unpackedHeader.VertexSize[i]);
-
-			std::tie(modelHeader.AlignedDecompressedSizes.Index[i],
-				modelHeader.BlockCount.Index[i],
-				modelHeader.FirstBlockOffsets.Index[i],
-				modelHeader.FirstBlockIndices.Index[i],
-				modelHeader.ChunkSizes.Index[i]) = generateSet(setIndexCounter++, unpackedHeader.IndexSize[i]);
-		}
+		modelHeader.AlignedDecompressedSizes.at(setIndex) = align(size).Alloc;
+		modelHeader.BlockCount.at(setIndex) = alignedBlock.Count;
+		modelHeader.FirstBlockOffsets.at(setIndex) = firstBlockOffset;
+		modelHeader.FirstBlockIndices.at(setIndex) = firstBlockIndex;
+		modelHeader.ChunkSizes.at(setIndex) = size ? nextBlockOffset - firstBlockOffset : 0;
 	}
 
 	return std::make_unique<memory_stream>(std::move(result));
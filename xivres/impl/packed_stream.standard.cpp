@@ -120,78 +120,47 @@ std::unique_ptr<xivres::stream> xivres::standard_compressing_packer::pack() {
 	const auto rawStreamSize = static_cast<uint32_t>(unpacked().size());
 
 	const auto blockAlignment = align<uint32_t>(rawStreamSize, packed::MaxBlockDataSize);
-	std::vector<block_data_t> blockDataList(blockAlignment.Count);
-
-	if (!multithreaded()) {
-		blockAlignment.iterate_chunks_breakable([&](const uint32_t index, const uint32_t offset, const uint32_t length) {
-			compress_block(offset, length, blockDataList[index]);
-			return !cancelled();
-		});
-		
-	} else {
-		util::thread_pool::task_waiter waiter;
-		preload();
-
-		blockAlignment.iterate_chunks_breakable([&](const uint32_t index, const uint32_t offset, const uint32_t length) {
-			waiter.submit([this, offset, length, &blockData = blockDataList[index]](auto& task) {
-				if (task.cancelled())
-					cancel();
-				if (!cancelled())
-					compress_block(offset, length, blockData);
-			});
-
-			return !cancelled();
-		});
-
-		if (!cancelled())
-			waiter.wait_all();
-	}
-
-	if (cancelled())
-		return nullptr;
+	std::vector<std::pair<uint32_t, uint32_t>> blocks;
+	blocks.reserve(blockAlignment.Count);
+	blockAlignment.iterate_chunks([&](uint32_t, uint32_t offset, uint32_t length) {
+		blocks.emplace_back(offset, length);
+	});
 
 	const auto entryHeaderLength = static_cast<uint16_t>(align(0
 		+ sizeof(packed::file_header)
 		+ sizeof(packed::standard_block_locator) * blockAlignment.Count
 	));
-	size_t entryBodyLength = 0;
-	for (const auto& blockData : blockDataList)
-		entryBodyLength += align(sizeof(packed::block_header) + blockData.Data.size());
-
-	std::vector<uint8_t> result(entryHeaderLength + entryBodyLength);
-
-	auto& entryHeader = *reinterpret_cast<packed::file_header*>(&result[0]);
-	entryHeader.Type = packed::type::standard;
-	entryHeader.DecompressedSize = rawStreamSize;
-	entryHeader.BlockCountOrVersion = static_cast<uint32_t>(blockAlignment.Count);
-	entryHeader.HeaderSize = entryHeaderLength;
-	entryHeader.set_space_units(entryBodyLength);
 
-	const auto locators = util::span_cast<packed::standard_block_locator>(result, sizeof entryHeader, blockAlignment.Count);
-	auto resultDataPtr = result.begin() + entryHeaderLength;
+	// Blocks are appended as soon as they are compressed, so only a bounded number of blocks is held besides the result.
+	std::vector<uint8_t> result(entryHeaderLength);
+	std::vector<packed::standard_block_locator> locators(blockAlignment.Count);
+	const auto completed = compress_blocks(blocks, [&](size_t index, block_data_t& blockData) {
+		const auto blockSize = static_cast<uint16_t>(align(sizeof(packed::block_header) + blockData.Data.size()));
+		const auto blockOffset = result.size();
+		result.resize(blockOffset + blockSize);
 
-	blockAlignment.iterate_chunks_breakable([&](const uint32_t index, const uint32_t offset, const uint32_t length) {
-		if (cancelled())
-			return false;
-		auto& blockData = blockDataList[index];
-
-		auto& header = *reinterpret_cast<packed::block_header*>(&*resultDataPtr);
+		auto& header = *reinterpret_cast<packed::block_header*>(&result[blockOffset]);
 		header.HeaderSize = sizeof(packed::block_header);
 		header.Version = 0;
 		header.CompressedSize = blockData.Deflated ? static_cast<uint32_t>(blockData.Data.size()) : packed::block_header::CompressedSizeNotCompressed;
-		header.DecompressedSize = length;
-
-		std::ranges::copy(blockData.Data, resultDataPtr + sizeof header);
+		header.DecompressedSize = blocks[index].second;
+		std::ranges::copy(blockData.Data, result.begin() + static_cast<std::ptrdiff_t>(blockOffset + sizeof header));
 
-		locators[index].Offset = index == 0 ? 0 : locators[index - 1].BlockSize + locators[index - 1].Offset;
-		locators[index].BlockSize = static_cast<uint16_t>(align(sizeof header + blockData.Data.size()));
-		locators[index].DecompressedDataSize = static_cast<uint16_t>(length);
+		locators[index].Offset = static_cast<uint32_t>(blockOffset - entryHeaderLength);
+		locators[index].BlockSize = blockSize;
+		locators[index].DecompressedDataSize = static_cast<uint16_t>(blocks[index].second);
+	});
+	if (!completed)
+		return nullptr;
 
-		resultDataPtr += locators[index].BlockSize;
+	auto& entryHeader = *reinterpret_cast<packed::file_header*>(&result[0]);
+	entryHeader.Type = packed::type::standard;
+	entryHeader.DecompressedSize = rawStreamSize;
+	entryHeader.BlockCountOrVersion = static_cast<uint32_t>(blockAlignment.Count);
+	entryHeader.HeaderSize = entryHeaderLength;
+	entryHeader.set_space_units(result.size() - entryHeaderLength);
 
-		std::vector<uint8_t>().swap(blockData.Data);
-		return true;
-	});
+	std::ranges::copy(locators, util::span_cast<packed::standard_block_locator>(result, sizeof entryHeader, blockAlignment.Count).begin());
 
 	return std::make_unique<memory_stream>(std::move(result));
 }
@@ -1,52 +1,5 @@
 #include "../include/xivres/path_spec.h"
 
-xivres::sqpack_spec::sqpack_spec(std::string_view part1, std::string_view part2, std::string_view part3) {
-	ExpacId = PartId = 0;
-
-	if (part1 == "common") {
-		CategoryId = 0x00;
-
-	} else if (part1 == "bgcommon") {
-		CategoryId = 0x01;
-
-	} else if (part1 == "bg") {
-		CategoryId = 0x02;
-		ExpacId = part2.size() > 2 && part2.starts_with("ex") ? static_cast<uint8_t>(std::strtol(&part2[2], nullptr, 10)) : 0;
-		PartId = ExpacId > 0U ? static_cast<uint8_t>(std::strtol(&part3[0], nullptr, 10)) : 0;
-
-	} else if (part1 == "cut") {
-		CategoryId = 0x03;
-		ExpacId = part2.size() > 2 && part2.starts_with("ex") ? static_cast<uint8_t>(std::strtol(&part2[2], nullptr, 10)) : 0;
-
-	} else if (part1 == "chara") {
-		CategoryId = 0x04;
-
-	} else if (part1 == "shader") {
-		CategoryId = 0x05;
-
-	} else if (part1 == "ui") {
-		CategoryId = 0x06;
-
-	} else if (part1 == "sound") {
-		CategoryId = 0x07;
-
-	} else if (part1 == "vfx") {
-		CategoryId = 0x08;
-
-	} else if (part1 == "exd") {
-		CategoryId = 0x0a;
-
-	} else if (part1 == "game_script") {
-		CategoryId = 0x0b;
-
-	} else if (part1 == "music") {
-		CategoryId = 0x0c;
-		ExpacId = part2.size() > 2 && part2.starts_with("ex") ? static_cast<uint8_t>(std::strtol(&part2[2], nullptr, 10)) : 0;
-
-	} else
-		CategoryId = 0x00;
-}
-
 std::string xivres::sqpack_spec::required_prefix() const {
 	switch (static_cast<uint32_t>(CategoryId)) {
 		case 0x00: return "common/";
@@ -232,3 +185,45 @@ void xivres::path_spec::recalculate_hash_values(bool checkSqPack) {
 			m_sqpack = {m_parts[0], m_parts[1], m_parts.size() > 2 ? m_parts[2] : std::string_view()};
 	}
 }
+
+std::string_view xivres::path_arena::intern(std::string_view text) {
+	std::lock_guard lock(m_mtx);
+	if (const auto it = m_interned.find(text); it != m_interned.end())
+		return *it;
+
+	char* ptr;
+	if (text.size() + 1 > BlockSize) {
+		// Oversized text gets a block of its own, kept before the block that is still being filled.
+		ptr = m_blocks.emplace(m_blocks.end() - (m_blocks.empty() ? 0 : 1), std::make_unique<char[]>(text.size() + 1))->get();
+	} else {
+		if (m_blockUsed + text.size() + 1 > BlockSize) {
+			m_blocks.emplace_back(std::make_unique<char[]>(BlockSize));
+			m_blockUsed = 0;
+		}
+		ptr = m_blocks.back().get() + m_blockUsed;
+		m_blockUsed += text.size() + 1;
+	}
+
+	std::copy_n(text.data(), text.size(), ptr);
+	ptr[text.size()] = 0;
+	m_sizeBytes += text.size() + 1;
+	return *m_interned.emplace(ptr, text.size()).first;
+}
+
+xivres::compact_path_spec::compact_path_spec(const path_spec& pathSpec, path_arena& arena)
+	: m_pathHash(pathSpec.path_hash())
+	, m_nameHash(pathSpec.name_hash())
+	, m_fullPathHash(pathSpec.full_path_hash())
+	, m_sqpack(sqpack_spec::from_filename_int(pathSpec.packid())) {
+	if (!pathSpec.has_original())
+		return;
+
+	if (pathSpec.text().size() > UINT16_MAX)
+		throw std::invalid_argument("path is too long");
+
+	const auto text = arena.intern(pathSpec.text());
+	m_text = text.data();
+	m_textLength = static_cast<uint16_t>(text.size());
+	if (const auto parts = pathSpec.parts(); !parts.empty())
+		m_nameOffset = static_cast<uint16_t>(parts.back().data() - pathSpec.text().data());
+}
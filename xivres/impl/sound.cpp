@@ -2,6 +2,10 @@
 
 #include <ranges>
 
+#if defined(_M_X64) || defined(__x86_64__)
+#include <emmintrin.h>
+#endif
+
 #include "../include/xivres/common.h"
 #include "../include/xivres/util.span_cast.h"
 
@@ -24,20 +28,112 @@ const uint8_t xivres::sound::sound_entry_ogg_header::Version3XorTable[256] = {
 	0x83, 0x26, 0xF9, 0x83, 0x2E, 0xFF, 0xE3, 0x16, 0x7D, 0xC0, 0x1E, 0x63, 0x21, 0x07, 0xE3, 0x01,
 };
 
+namespace {
+	// Writes src XORed with a key that repeats every 256 bytes into dst; src and dst may be the same buffer.
+	void xor_with_repeating_key(std::span<const uint8_t> src, std::span<uint8_t> dst, const uint8_t(&key)[256]) {
+		if (src.size() != dst.size())
+			throw std::invalid_argument("source and destination must be of the same size");
+
+		auto srcPtr = src.data();
+		auto dstPtr = dst.data();
+		auto remaining = src.size();
+
+#if defined(_M_X64) || defined(__x86_64__)
+		__m128i keys[16];
+		for (size_t i = 0; i < 16; i++)
+			keys[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&key[i * 16]));
+
+		for (; remaining >= 256; remaining -= 256, srcPtr += 256, dstPtr += 256) {
+			for (size_t i = 0; i < 16; i++) {
+				const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcPtr + i * 16));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dstPtr + i * 16), _mm_xor_si128(v, keys[i]));
+			}
+		}
+#endif
+
+		for (size_t i = 0; i < remaining; i++)
+			dstPtr[i] = srcPtr[i] ^ key[i & 0xFF];
+	}
+}
+
+void xivres::sound::sound_entry_ogg_header::decode_version2(std::span<uint8_t> data, uint8_t encodeByte) {
+	decode_version2(data, data, encodeByte);
+}
+
+void xivres::sound::sound_entry_ogg_header::decode_version2(std::span<const uint8_t> src, std::span<uint8_t> dst, uint8_t encodeByte) {
+	if (!encodeByte) {
+		if (src.size() != dst.size())
+			throw std::invalid_argument("source and destination must be of the same size");
+		if (src.data() != dst.data())
+			std::ranges::copy(src, dst.begin());
+		return;
+	}
+
+	uint8_t key[256];
+	memset(key, encodeByte, sizeof key);
+	xor_with_repeating_key(src, dst, key);
+}
+
+void xivres::sound::sound_entry_ogg_header::decode_version3(std::span<uint8_t> data, size_t streamDataSize, size_t offset) {
+	decode_version3(data, data, streamDataSize, offset);
+}
+
+void xivres::sound::sound_entry_ogg_header::decode_version3(std::span<const uint8_t> src, std::span<uint8_t> dst, size_t streamDataSize, size_t offset) {
+	const auto byte1 = static_cast<uint8_t>(streamDataSize & 0x7F);
+	const auto byte2 = static_cast<uint8_t>(streamDataSize & 0x3F);
+
+	uint8_t key[256];
+	for (size_t i = 0; i < 256; i++)
+		key[i] = Version3XorTable[(byte2 + offset + i) & 0xFF] ^ byte1;
+	xor_with_repeating_key(src, dst, key);
+}
+
 std::vector<uint8_t> xivres::sound::reader::read_entry(const std::span<const uint32_t>& offsets, uint32_t endOffset, size_t index) const {
 	if (!offsets[index])
 		return {};
 	const auto next = index == offsets.size() - 1 || offsets[index + 1] == 0 ? endOffset : offsets[index + 1];
+	if (!m_view.empty()) {
+		if (next > m_view.size() || next < offsets[index])
+			throw bad_data_error("sound entry exceeds file size");
+		const auto view = m_view.subspan(offsets[index], size_t() + next - offsets[index]);
+		return {view.begin(), view.end()};
+	}
 	return m_stream->read_vector<uint8_t>(offsets[index], size_t() + next - offsets[index]);
 }
 
 std::vector<std::vector<uint8_t>> xivres::sound::reader::read_table(const std::span<const uint32_t>& offsets, uint32_t endOffset) const {
 	std::vector<std::vector<uint8_t>> res;
+	res.reserve(offsets.size());
 	for (uint32_t i = 0; i < offsets.size(); ++i)
 		res.emplace_back(read_entry(offsets, endOffset, i));
 	return res;
 }
 
+std::span<const uint8_t> xivres::sound::reader::view_entry(const std::span<const uint32_t>& offsets, uint32_t endOffset, size_t index) const {
+	if (m_view.empty())
+		throw std::logic_error("sound::reader is not backed by a memory_stream");
+	if (!offsets[index])
+		return {};
+	const auto next = index == offsets.size() - 1 || offsets[index + 1] == 0 ? endOffset : offsets[index + 1];
+	if (next > m_view.size() || next < offsets[index])
+		throw bad_data_error("sound entry exceeds file size");
+	return m_view.subspan(offsets[index], size_t() + next - offsets[index]);
+}
+
+std::vector<std::span<const uint8_t>> xivres::sound::reader::view_table(const std::span<const uint32_t>& offsets, uint32_t endOffset) const {
+	std::vector<std::span<const uint8_t>> res;
+	res.reserve(offsets.size());
+	for (uint32_t i = 0; i < offsets.size(); ++i)
+		res.emplace_back(view_entry(offsets, endOffset, i));
+	return res;
+}
+
+std::span<const uint8_t> xivres::sound::reader::get_memory_view(const stream& strm) {
+	if (const auto ms = dynamic_cast<const memory_stream*>(&strm))
+		return ms->as_span(0, ms->size());
+	return {};
+}
+
 std::vector<uint8_t> xivres::sound::reader::get_header_bytes(const stream& strm) {
 	constexpr auto InitialBufferSize = 8192ULL;
 	std::vector<uint8_t> res;
@@ -69,7 +165,8 @@ xivres::sound::reader::reader(std::shared_ptr<stream> strm)
 	, m_endOfTable5(!m_soundEntryOffsets.empty() && m_soundEntryOffsets.front() ? m_soundEntryOffsets.front() : m_endOfSoundEntries)
 	, m_endOfTable2(!m_offsetsTable5.empty() && m_offsetsTable5.front() ? m_offsetsTable5.front() : m_endOfTable5)
 	, m_endOfTable1(!m_offsetsTable2.empty() && m_offsetsTable2.front() ? m_offsetsTable2.front() : m_endOfTable2)
-	, m_endOfTable4(!m_offsetsTable1.empty() && m_offsetsTable1.front() ? m_offsetsTable1.front() : m_endOfTable1) {
+	, m_endOfTable4(!m_offsetsTable1.empty() && m_offsetsTable1.front() ? m_offsetsTable1.front() : m_endOfTable1)
+	, m_view(get_memory_view(*m_stream)) {
 }
 
 std::vector<uint32_t> xivres::sound::reader::sound_item::marked_sample_block_indices() const {
@@ -100,28 +197,40 @@ const xivres::sound::adpcm_wave_format& xivres::sound::reader::sound_item::get_a
 	return *reinterpret_cast<const adpcm_wave_format*>(&get_wav_header());
 }
 
-std::vector<uint8_t> xivres::sound::reader::sound_item::get_wav_file() const {
+size_t xivres::sound::reader::sound_item::get_wav_file_size() const {
+	const auto& hdr = get_wav_header();
+	return size_t()
+		+ 12 // "RIFF"####"WAVE"
+		+ 8 + sizeof hdr + hdr.cbSize // "fmt "####<header>
+		+ 8 + Data.size(); // "data"####<data>
+}
+
+void xivres::sound::reader::sound_item::write_wav_file(std::span<uint8_t> out) const {
 	const auto& hdr = get_wav_header();
 	const auto headerSpan = ExtraData.subspan(0, sizeof hdr + hdr.cbSize);
-	std::vector<uint8_t> res;
-	const auto insert = [&res](const auto& v) {
-		res.insert(res.end(), reinterpret_cast<const uint8_t*>(&v), reinterpret_cast<const uint8_t*>(&v) + sizeof v);
+	const auto totalLength = static_cast<uint32_t>(get_wav_file_size());
+	if (out.size() != totalLength)
+		throw std::invalid_argument("output buffer size must be equal to get_wav_file_size()");
+
+	const auto insert = [&out](const auto& v) {
+		memcpy(out.data(), &v, sizeof v);
+		out = out.subspan(sizeof v);
 	};
-	const auto totalLength = static_cast<uint32_t>(size_t()
-		+ 12 // "RIFF"####"WAVE"
-		+ 8 + headerSpan.size() // "fmt "####<header>
-		+ 8 + Data.size() // "data"####<data>
-	);
-	res.reserve(totalLength);
 	insert(LE<uint32_t>(0x46464952U)); // "RIFF"
 	insert(LE<uint32_t>(totalLength - 8));
 	insert(LE<uint32_t>(0x45564157U)); // "WAVE"
 	insert(LE<uint32_t>(0x20746D66U)); // "fmt "
 	insert(LE<uint32_t>(static_cast<uint32_t>(headerSpan.size())));
-	res.insert(res.end(), headerSpan.begin(), headerSpan.end());
+	std::ranges::copy(headerSpan, out.begin());
+	out = out.subspan(headerSpan.size());
 	insert(LE<uint32_t>(0x61746164U)); // "data"
 	insert(LE<uint32_t>(static_cast<uint32_t>(Data.size())));
-	res.insert(res.end(), Data.begin(), Data.end());
+	std::ranges::copy(Data, out.begin());
+}
+
+std::vector<uint8_t> xivres::sound::reader::sound_item::get_wav_file() const {
+	std::vector<uint8_t> res(get_wav_file_size());
+	write_wav_file(res);
 	return res;
 }
 
@@ -130,7 +239,7 @@ const xivres::sound::sound_entry_ogg_header& xivres::sound::reader::sound_item::
 		throw std::invalid_argument("Not ogg");
 	if (ExtraData.size_bytes() < sizeof sound_entry_ogg_header)
 		throw std::invalid_argument("ExtraData too small to fit OggSeekTableHeader");
-	const auto& header = *reinterpret_cast<sound_entry_ogg_header*>(&ExtraData[0]);
+	const auto& header = *reinterpret_cast<const sound_entry_ogg_header*>(&ExtraData[0]);
 	if (header.HeaderSize != sizeof header)
 		throw std::invalid_argument("invalid OggSeekTableHeader size");
 	return header;
@@ -142,27 +251,30 @@ std::span<const uint32_t> xivres::sound::reader::sound_item::get_ogg_seek_table(
 	return util::span_cast<uint32_t>(span);
 }
 
-std::vector<uint8_t> xivres::sound::reader::sound_item::get_ogg_file() const {
+size_t xivres::sound::reader::sound_item::get_ogg_file_size() const {
+	const auto& tbl = get_ogg_seek_table_header();
+	return size_t() + tbl.VorbisHeaderSize + Data.size();
+}
+
+void xivres::sound::reader::sound_item::write_ogg_file(std::span<uint8_t> out) const {
 	const auto& tbl = get_ogg_seek_table_header();
 	const auto header = ExtraData.subspan(size_t() + tbl.HeaderSize + tbl.SeekTableSize, tbl.VorbisHeaderSize);
-	std::vector<uint8_t> res;
-	res.reserve(header.size() + Data.size());
-	res.insert(res.end(), header.begin(), header.end());
-	res.insert(res.end(), Data.begin(), Data.end());
+	if (out.size() != header.size() + Data.size())
+		throw std::invalid_argument("output buffer size must be equal to get_ogg_file_size()");
 
 	if (tbl.Version == 0x2) {
-		if (tbl.EncodeByte) {
-			for (auto& c : std::span(res).subspan(0, header.size()))
-				c ^= tbl.EncodeByte;
-		}
+		sound_entry_ogg_header::decode_version2(header, out.subspan(0, header.size()), tbl.EncodeByte);
+		std::ranges::copy(Data, out.begin() + header.size());
 	} else if (tbl.Version == 0x3) {
-		const auto byte1 = static_cast<uint8_t>(Data.size() & 0x7F);
-		const auto byte2 = static_cast<uint8_t>(Data.size() & 0x3F);
-		for (size_t i = 0; i < res.size(); i++)
-			res[i] ^= sound_entry_ogg_header::Version3XorTable[(byte2 + i) & 0xFF] ^ byte1;
-	} else {
+		sound_entry_ogg_header::decode_version3(header, out.subspan(0, header.size()), Data.size());
+		sound_entry_ogg_header::decode_version3(Data, out.subspan(header.size()), Data.size(), header.size());
+	} else
 		throw bad_data_error(std::format("Unsupported scd ogg header version: {}", tbl.Version));
-	}
+}
+
+std::vector<uint8_t> xivres::sound::reader::sound_item::get_ogg_file() const {
+	std::vector<uint8_t> res(get_ogg_file_size());
+	write_ogg_file(res);
 	return res;
 }
 
@@ -171,20 +283,30 @@ xivres::sound::reader::sound_item xivres::sound::reader::read_sound_item(size_t
 		throw std::out_of_range("entry index >= sound entry count");
 
 	sound_item res{};
-	res.Buffer = read_entry(m_soundEntryOffsets, m_endOfSoundEntries, static_cast<uint32_t>(entryIndex));
-	res.Header = reinterpret_cast<sound_entry_header*>(&res.Buffer[0]);
-	
-	if (const auto minSize = sizeof *res.Header + res.Header->StreamOffset + res.Header->StreamSize; res.Buffer.size() < minSize) {
-		res.Buffer.resize(minSize);	
-		res.Header = reinterpret_cast<sound_entry_header*>(&res.Buffer[0]);
-	}
+	std::span<const uint8_t> entry;
+	if (!m_view.empty())
+		entry = view_entry(m_soundEntryOffsets, m_endOfSoundEntries, entryIndex);
+
+	if (const auto header = reinterpret_cast<const sound_entry_header*>(entry.data());
+		entry.size() < sizeof *header || entry.size() < sizeof *header + header->StreamOffset + header->StreamSize) {
+		res.Buffer = read_entry(m_soundEntryOffsets, m_endOfSoundEntries, static_cast<uint32_t>(entryIndex));
+		res.Header = reinterpret_cast<const sound_entry_header*>(&res.Buffer[0]);
+
+		if (const auto minSize = sizeof *res.Header + res.Header->StreamOffset + res.Header->StreamSize; res.Buffer.size() < minSize) {
+			res.Buffer.resize(minSize);
+			res.Header = reinterpret_cast<const sound_entry_header*>(&res.Buffer[0]);
+		}
+		entry = std::span(res.Buffer);
+	} else
+		res.Header = header;
+
 	auto pos = sizeof *res.Header;
 	for (size_t i = 0; i < res.Header->AuxChunkCount; ++i) {
-		res.AuxChunks.emplace_back(reinterpret_cast<sound_entry_aux_chunk*>(&res.Buffer[pos]));
+		res.AuxChunks.emplace_back(reinterpret_cast<const sound_entry_aux_chunk*>(&entry[pos]));
 		pos += res.AuxChunks.back()->ChunkSize;
 	}
-	res.ExtraData = std::span(res.Buffer).subspan(pos, res.Header->StreamOffset + sizeof *res.Header - pos);
-	res.Data = std::span(res.Buffer).subspan(sizeof *res.Header + res.Header->StreamOffset, res.Header->StreamSize);
+	res.ExtraData = entry.subspan(pos, res.Header->StreamOffset + sizeof *res.Header - pos);
+	res.Data = entry.subspan(sizeof *res.Header + res.Header->StreamOffset, res.Header->StreamSize);
 	return res;
 }
 
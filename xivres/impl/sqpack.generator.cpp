@@ -1,7 +1,17 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "../include/xivres/sqpack.generator.h"
 
 #include <fstream>
 #include <ranges>
+#include <set>
 
 #include "../include/xivres/packed_stream.hotswap.h"
 #include "../include/xivres/packed_stream.model.h"
@@ -98,8 +108,39 @@ xivres::sqpack::generator::sqpack_view_entry_cache::buffered_entry* xivres::sqpa
 	return &m_lastActiveEntry;
 }
 
-xivres::sqpack::generator::generator(std::string ex, std::string name, uint64_t maxFileSize)
+// Removes entries whose packed data matches an entry seen in this or an earlier window, and records them along with
+// that entry; they are neither laid out nor written, and point at their source once it has been placed.
+static void take_duplicates(
+	std::vector<xivres::sqpack::generator::entry_info*>& window,
+	std::vector<uint64_t>& entrySizes,
+	std::vector<std::vector<char>>& packedData,
+	std::map<xivres::sha1_value, xivres::sqpack::generator::entry_info*>& sources,
+	std::vector<std::pair<xivres::sqpack::generator::entry_info*, xivres::sqpack::generator::entry_info*>>& duplicates) {
+	size_t kept = 0;
+	for (size_t i = 0; i < window.size(); ++i) {
+		if (window[i]->ContentHash) {
+			if (const auto [it, inserted] = sources.emplace(*window[i]->ContentHash, window[i]); !inserted) {
+				window[i]->Provider.reset();
+				duplicates.emplace_back(window[i], it->second);
+				continue;
+			}
+		}
+
+		window[kept] = window[i];
+		entrySizes[kept] = entrySizes[i];
+		if (!packedData.empty())
+			packedData[kept] = std::move(packedData[i]);
+		++kept;
+	}
+	window.resize(kept);
+	entrySizes.resize(kept);
+	if (!packedData.empty())
+		packedData.resize(kept);
+}
+
+xivres::sqpack::generator::generator(std::string ex, std::string name, uint64_t maxFileSize, bool deduplicate)
 	: m_maxFileSize(maxFileSize)
+	, m_deduplicate(deduplicate)
 	, DatExpac(std::move(ex))
 	, DatName(std::move(name)) {
 	if (maxFileSize > sqdata::header::MaxFileSize_MaxValue)
@@ -274,7 +315,6 @@ static std::vector<uint8_t> export_index_file_data(
 	}
 
 	if (strict) {
-		header2.Sha1.set_from_span(reinterpret_cast<char*>(&header2), offsetof(sqpack::sqindex::header, Sha1));
 		if (!fileSegment.empty())
 			header2.HashLocatorSegment.Sha1.set_from_span(reinterpret_cast<const uint8_t*>(&fileSegment.front()), header2.HashLocatorSegment.Size);
 		if (!conflictSegment.empty())
@@ -286,6 +326,8 @@ static std::vector<uint8_t> export_index_file_data(
 				header2.PathHashLocatorSegment.Sha1.set_from_span(reinterpret_cast<const uint8_t*>(&folderSegment.front()), header2.PathHashLocatorSegment.Size);
 		}
 
+		// The header hash covers the segment hashes above, so it has to come last.
+		header2.Sha1.set_from_span(reinterpret_cast<char*>(&header2), offsetof(sqpack::sqindex::header, Sha1));
 	}
 	if (!fileSegment.empty())
 		data.insert(data.end(), reinterpret_cast<const uint8_t*>(&fileSegment.front()), reinterpret_cast<const uint8_t*>(&fileSegment.back() + 1));
@@ -392,11 +434,174 @@ public:
 	}
 };
 
+static xivres::sqpack::header make_data_header(bool strict) {
+	using namespace xivres::sqpack;
+
+	header dataHeader{};
+	memcpy(dataHeader.Signature, header::Signature_Value, sizeof(header::Signature_Value));
+	dataHeader.HeaderSize = sizeof header;
+	dataHeader.Unknown1 = header::Unknown1_Value;
+	dataHeader.Type = file_type::SqData;
+	dataHeader.Unknown2 = header::Unknown2_Value;
+	if (strict)
+		dataHeader.Sha1.set_from_span(reinterpret_cast<char*>(&dataHeader), offsetof(header, Sha1));
+	return dataHeader;
+}
+
+// Output file whose space is reserved ahead of the writes, and accepts positioned writes from multiple threads at once.
+// Existing contents are kept if keepExisting is set; the file is only ever grown.
+class xivres::sqpack::generator::preallocated_output_file {
+#ifdef _WIN32
+	const HANDLE m_hFile;
+	uint64_t m_size = 0;
+	mutable util::thread_pool::object_pool<std::shared_ptr<void>> m_hEvents;
+
+public:
+	preallocated_output_file(const std::filesystem::path& path, uint64_t size, bool keepExisting)
+		: m_hFile(CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, keepExisting ? OPEN_ALWAYS : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, nullptr)) {
+		if (m_hFile == INVALID_HANDLE_VALUE)
+			throw std::system_error(std::error_code(static_cast<int>(GetLastError()), std::system_category()));
+
+		LARGE_INTEGER currentSize{};
+		if (keepExisting && GetFileSizeEx(m_hFile, &currentSize))
+			m_size = static_cast<uint64_t>(currentSize.QuadPart);
+
+		try {
+			reserve(size);
+		} catch (...) {
+			CloseHandle(m_hFile);
+			throw;
+		}
+	}
+
+	~preallocated_output_file() {
+		CloseHandle(m_hFile);
+	}
+
+	// Grows the file to at least size bytes. Must not be called while writes are in flight.
+	void reserve(uint64_t size) {
+		if (size <= m_size)
+			return;
+
+		FILE_ALLOCATION_INFO allocationInfo{};
+		allocationInfo.AllocationSize.QuadPart = static_cast<LONGLONG>(size);
+		FILE_END_OF_FILE_INFO endOfFileInfo{};
+		endOfFileInfo.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+		if (!SetFileInformationByHandle(m_hFile, FileAllocationInfo, &allocationInfo, sizeof allocationInfo)
+			|| !SetFileInformationByHandle(m_hFile, FileEndOfFileInfo, &endOfFileInfo, sizeof endOfFileInfo))
+			throw std::system_error(std::error_code(static_cast<int>(GetLastError()), std::system_category()));
+
+		m_size = size;
+	}
+
+	void write(uint64_t offset, const void* buf, size_t length) const {
+		auto hEvent = *m_hEvents;
+		if (!hEvent) {
+			const auto handle = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+			if (handle == nullptr)
+				throw std::system_error(std::error_code(static_cast<int>(GetLastError()), std::system_category()));
+			hEvent.emplace(handle, [](HANDLE h) { CloseHandle(h); });
+		}
+
+		constexpr size_t ChunkSize = 0x10000000;
+		for (auto ptr = static_cast<const char*>(buf); length;) {
+			OVERLAPPED ov{};
+			ov.hEvent = hEvent->get();
+			ov.Offset = static_cast<DWORD>(offset);
+			ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+			DWORD written = 0;
+			if (!WriteFile(m_hFile, ptr, static_cast<DWORD>((std::min)(length, ChunkSize)), nullptr, &ov)) {
+				if (const auto err = GetLastError(); err != ERROR_IO_PENDING)
+					throw std::system_error(std::error_code(static_cast<int>(err), std::system_category()));
+			}
+			if (!GetOverlappedResult(m_hFile, &ov, &written, TRUE))
+				throw std::system_error(std::error_code(static_cast<int>(GetLastError()), std::system_category()));
+			if (!written)
+				throw std::runtime_error("Failed to write to output data file.");
+
+			ptr += written;
+			offset += written;
+			length -= written;
+		}
+	}
+
+#else
+	const int m_fd;
+	uint64_t m_size = 0;
+
+public:
+	preallocated_output_file(const std::filesystem::path& path, uint64_t size, bool keepExisting)
+		: m_fd(open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | (keepExisting ? 0 : O_TRUNC), 0644)) {
+		if (m_fd == -1)
+			throw std::system_error(std::error_code(errno, std::generic_category()));
+
+		if (struct stat st{}; keepExisting && fstat(m_fd, &st) == 0)
+			m_size = static_cast<uint64_t>(st.st_size);
+
+		try {
+			reserve(size);
+		} catch (...) {
+			close(m_fd);
+			throw;
+		}
+	}
+
+	~preallocated_output_file() {
+		close(m_fd);
+	}
+
+	// Grows the file to at least size bytes. Must not be called while writes are in flight.
+	void reserve(uint64_t size) {
+		if (size <= m_size)
+			return;
+
+		// Fall back to a sparse file on filesystems that cannot reserve space.
+		auto err = posix_fallocate(m_fd, static_cast<off_t>(m_size), static_cast<off_t>(size - m_size));
+		if (err == EINVAL || err == EOPNOTSUPP)
+			err = ftruncate(m_fd, static_cast<off_t>(size)) == -1 ? errno : 0;
+		if (err)
+			throw std::system_error(std::error_code(err, std::generic_category()));
+
+		m_size = size;
+	}
+
+	void write(uint64_t offset, const void* buf, size_t length) const {
+		for (auto ptr = static_cast<const char*>(buf); length;) {
+			const auto written = pwrite(m_fd, ptr, length, static_cast<off_t>(offset));
+			if (written == -1) {
+				if (errno == EINTR)
+					continue;
+				throw std::system_error(std::error_code(errno, std::generic_category()));
+			}
+			if (!written)
+				throw std::runtime_error("Failed to write to output data file.");
+
+			ptr += written;
+			offset += written;
+			length -= static_cast<size_t>(written);
+		}
+	}
+#endif
+
+	preallocated_output_file(preallocated_output_file&&) = delete;
+	preallocated_output_file(const preallocated_output_file&) = delete;
+	preallocated_output_file& operator=(preallocated_output_file&&) = delete;
+	preallocated_output_file& operator=(const preallocated_output_file&) = delete;
+};
+
 xivres::sqpack::generator::sqpack_views xivres::sqpack::generator::export_to_views(bool strict, const std::shared_ptr<sqpack_view_entry_cache>& dataBuffer) {
 	header dataHeader{};
 	std::vector<sqdata::header> dataSubheaders;
 	std::vector<std::pair<size_t, size_t>> dataEntryRanges;
 
+	// Views are laid out before any entry is read, and each entry can be swapped out on its own later; entries cannot
+	// share space here.
+	if (m_deduplicate)
+		throw std::logic_error("export_to_views does not support deduplication; export to files instead");
+
+	m_deduplicated.clear();
+
 	auto res = sqpack_views{
 		.HashOnlyEntries = std::move(m_hashOnlyEntries),
 		.FullPathEntries = std::move(m_fullEntries),
@@ -425,22 +630,6 @@ xivres::sqpack::generator::sqpack_views xivres::sqpack::generator::export_to_vie
 
 		if (dataSubheaders.empty() ||
 			sizeof header + sizeof(sqdata::header) + dataSubheaders.back().DataSize + entry->EntrySize > dataSubheaders.back().MaxFileSize) {
-			if (strict && !dataSubheaders.empty()) {
-				util::hash_sha1 sha1;
-				for (auto j = dataEntryRanges.back().first, j_ = j + dataEntryRanges.back().second; j < j_; ++j) {
-					const auto& entry = res.Entries[j];
-					const auto& provider = *entry->Provider;
-					const auto length = provider.size();
-					uint8_t buf[4096];
-					for (std::streamoff j = 0; j < length; j += sizeof buf) {
-						const auto readlen = static_cast<size_t>((std::min<uint64_t>)(sizeof buf, length - j));
-						provider.read_fully(j, buf, static_cast<std::streamsize>(readlen));
-						sha1.process_bytes(buf, readlen);
-					}
-				}
-				sha1.get_digest_bytes(dataSubheaders.back().DataSha1.Value);
-				dataSubheaders.back().Sha1.set_from_span(reinterpret_cast<char*>(&dataSubheaders.back()), offsetof(sqdata::header, Sha1));
-			}
 			dataSubheaders.emplace_back(sqdata::header{
 				.HeaderSize = sizeof(sqdata::header),
 				.Unknown1 = sqdata::header::Unknown1_Value,
@@ -458,20 +647,27 @@ xivres::sqpack::generator::sqpack_views xivres::sqpack::generator::export_to_vie
 	}
 
 	if (strict && !dataSubheaders.empty()) {
-		util::hash_sha1 sha1;
-		for (auto j = dataEntryRanges.back().first, j_ = j + dataEntryRanges.back().second; j < j_; ++j) {
-			const auto& entry = res.Entries[j];
-			const auto& provider = *entry->Provider;
-			const auto length = provider.size();
-			uint8_t buf[4096];
-			for (std::streamoff j = 0; j < length; j += sizeof buf) {
-				const auto readlen = static_cast<size_t>((std::min<uint64_t>)(sizeof buf, length - j));
-				provider.read_fully(j, buf, static_cast<std::streamsize>(readlen));
-				sha1.process_bytes(buf, readlen);
+		// Entries are read in parallel, and hashed in order as they become available.
+		const auto dataSha1 = std::make_unique<util::hash_sha1[]>(dataSubheaders.size());
+		util::thread_pool::task_waiter<std::pair<size_t, std::vector<uint8_t>>> waiter;
+		std::map<size_t, std::vector<uint8_t>> readyEntries;
+		for (size_t nextToSubmit = 0, nextToHash = 0; nextToHash < res.Entries.size();) {
+			for (; nextToSubmit < res.Entries.size() && waiter.pending() + readyEntries.size() < (std::max<size_t>)(8, 2 * waiter.pool().concurrency()); ++nextToSubmit) {
+				waiter.submit([i = nextToSubmit, entry = res.Entries[nextToSubmit]](util::thread_pool::base_task& task) {
+					task.throw_if_cancelled();
+					return std::make_pair(i, entry->Provider->read_vector<uint8_t>());
+				});
 			}
+
+			readyEntries.emplace(std::move(*waiter.get()));
+			for (auto it = readyEntries.begin(); it != readyEntries.end() && it->first == nextToHash; it = readyEntries.erase(it), ++nextToHash)
+				dataSha1[res.Entries[nextToHash]->Locator.DatFileIndex].process_bytes(it->second.data(), it->second.size());
+		}
+
+		for (size_t i = 0; i < dataSubheaders.size(); ++i) {
+			dataSha1[i].get_digest_bytes(dataSubheaders[i].DataSha1.Value);
+			dataSubheaders[i].Sha1.set_from_span(reinterpret_cast<char*>(&dataSubheaders[i]), offsetof(sqdata::header, Sha1));
 		}
-		sha1.get_digest_bytes(dataSubheaders.back().DataSha1.Value);
-		dataSubheaders.back().Sha1.set_from_span(reinterpret_cast<char*>(&dataSubheaders.back()), offsetof(sqdata::header, Sha1));
 	}
 
 	std::vector<sqindex::pair_hash_locator> fileEntries1;
@@ -546,84 +742,168 @@ xivres::sqpack::generator::sqpack_views xivres::sqpack::generator::export_to_vie
 	return res;
 }
 
-void xivres::sqpack::generator::export_to_files(const std::filesystem::path& dir, bool strict, size_t cores) {
-	header dataHeader{};
-	memcpy(dataHeader.Signature, header::Signature_Value, sizeof(header::Signature_Value));
-	dataHeader.HeaderSize = sizeof header;
-	dataHeader.Unknown1 = header::Unknown1_Value;
-	dataHeader.Type = file_type::SqData;
-	dataHeader.Unknown2 = header::Unknown2_Value;
-	if (strict)
-		dataHeader.Sha1.set_from_span(reinterpret_cast<char*>(&dataHeader), offsetof(sqpack::header, Sha1));
-
-	std::vector<sqdata::header> dataSubheaders;
-
-	std::vector<std::unique_ptr<entry_info>> entries;
+std::vector<std::pair<xivres::path_spec, std::unique_ptr<xivres::sqpack::generator::entry_info>>> xivres::sqpack::generator::take_entries() {
+	std::vector<std::pair<path_spec, std::unique_ptr<entry_info>>> entries;
 	entries.reserve(m_fullEntries.size() + m_hashOnlyEntries.size());
-	for (auto& val : m_fullEntries | std::views::values)
-		entries.emplace_back(std::move(val));
-	for (auto& val : m_hashOnlyEntries | std::views::values)
-		entries.emplace_back(std::move(val));
+	for (auto& val : m_fullEntries | std::views::values) {
+		auto pathSpec = val->Provider->path_spec();
+		entries.emplace_back(std::move(pathSpec), std::move(val));
+	}
+	for (auto& val : m_hashOnlyEntries | std::views::values) {
+		auto pathSpec = val->Provider->path_spec();
+		entries.emplace_back(std::move(pathSpec), std::move(val));
+	}
 	m_fullEntries.clear();
 	m_hashOnlyEntries.clear();
+	return entries;
+}
 
-	std::map<std::pair<uint32_t, uint32_t>, std::vector<entry_info*>> pairHashes;
-	std::map<uint32_t, std::vector<entry_info*>> fullHashes;
-	std::map<entry_info*, path_spec> entryPathSpecs;
-	for (const auto& entry : entries) {
-		const auto& pathSpec = entry->Provider->path_spec();
-		entryPathSpecs.emplace(entry.get(), pathSpec);
-		pairHashes[std::make_pair(pathSpec.path_hash(), pathSpec.name_hash())].emplace_back(entry.get());
-		fullHashes[pathSpec.full_path_hash()].emplace_back(entry.get());
+void xivres::sqpack::generator::export_index_files(const std::filesystem::path& dir, const std::vector<std::pair<path_spec, std::unique_ptr<entry_info>>>& entries, size_t dataFilesCount, bool strict) const {
+	std::vector<index_item> items;
+	items.reserve(entries.size());
+	for (const auto& [pathSpec, entry] : entries)
+		items.emplace_back(&pathSpec, entry.get());
+	export_index_files(dir, items, items, dataFilesCount, strict);
+}
+
+void xivres::sqpack::generator::export_index_files(const std::filesystem::path& dir, std::span<const index_item> index1Items, std::span<const index_item> index2Items, size_t dataFilesCount, bool strict) const {
+	std::map<std::pair<uint32_t, uint32_t>, std::vector<const index_item*>> pairHashes;
+	for (const auto& item : index1Items)
+		pairHashes[std::make_pair(item.first->path_hash(), item.first->name_hash())].emplace_back(&item);
+
+	std::map<uint32_t, std::vector<const index_item*>> fullHashes;
+	for (const auto& item : index2Items)
+		fullHashes[item.first->full_path_hash()].emplace_back(&item);
+
+	std::vector<sqindex::pair_hash_locator> fileEntries1;
+	std::vector<sqindex::pair_hash_with_text_locator> conflictEntries1;
+	for (const auto& [pairHash, correspondingEntries] : pairHashes) {
+		if (correspondingEntries.size() == 1) {
+			fileEntries1.emplace_back(sqindex::pair_hash_locator{pairHash.second, pairHash.first, correspondingEntries.front()->second->Locator, 0});
+		} else {
+			fileEntries1.emplace_back(sqindex::pair_hash_locator{pairHash.second, pairHash.first, sqindex::data_locator::Synonym(), 0});
+			uint32_t i = 0;
+			for (const auto& entry : correspondingEntries) {
+				conflictEntries1.emplace_back(sqindex::pair_hash_with_text_locator{
+					.NameHash = pairHash.second,
+					.PathHash = pairHash.first,
+					.Locator = entry->second->Locator,
+					.ConflictIndex = i++,
+				});
+				const auto& path = entry->first->text();
+				strncpy_s(conflictEntries1.back().FullPath, path.c_str(), path.size());
+			}
+		}
 	}
+	conflictEntries1.emplace_back(sqindex::pair_hash_with_text_locator{
+		.NameHash = sqindex::pair_hash_with_text_locator::EndOfList,
+		.PathHash = sqindex::pair_hash_with_text_locator::EndOfList,
+		.Locator = 0,
+		.ConflictIndex = sqindex::pair_hash_with_text_locator::EndOfList,
+	});
 
-	std::vector<sqindex::data_locator> locators;
+	std::vector<sqindex::full_hash_locator> fileEntries2;
+	std::vector<sqindex::full_hash_with_text_locator> conflictEntries2;
+	for (const auto& [fullHash, correspondingEntries] : fullHashes) {
+		if (correspondingEntries.size() == 1) {
+			fileEntries2.emplace_back(sqindex::full_hash_locator{fullHash, correspondingEntries.front()->second->Locator});
+		} else {
+			fileEntries2.emplace_back(sqindex::full_hash_locator{fullHash, sqindex::data_locator::Synonym()});
+			uint32_t i = 0;
+			for (const auto& entry : correspondingEntries) {
+				conflictEntries2.emplace_back(sqindex::full_hash_with_text_locator{
+					.FullPathHash = fullHash,
+					.UnusedHash = 0,
+					.Locator = entry->second->Locator,
+					.ConflictIndex = i++,
+				});
+				const auto& path = entry->first->text();
+				strncpy_s(conflictEntries2.back().FullPath, path.c_str(), path.size());
+			}
+		}
+	}
+	conflictEntries2.emplace_back(sqindex::full_hash_with_text_locator{
+		.FullPathHash = sqindex::full_hash_with_text_locator::EndOfList,
+		.UnusedHash = sqindex::full_hash_with_text_locator::EndOfList,
+		.Locator = 0,
+		.ConflictIndex = sqindex::full_hash_with_text_locator::EndOfList,
+	});
+
+	auto indexData = export_index_file_data<sqindex::sqindex_type::Index, sqindex::pair_hash_locator, sqindex::pair_hash_with_text_locator, true>(
+		dataFilesCount, std::move(fileEntries1), conflictEntries1, m_sqpackIndexSegment3, std::vector<sqindex::path_hash_locator>(), strict);
+	std::ofstream(dir / std::format("{}.win32.index", DatName), std::ios::binary).write(reinterpret_cast<const char*>(&indexData[0]), indexData.size());
+
+	indexData = export_index_file_data<sqindex::sqindex_type::Index, sqindex::full_hash_locator, sqindex::full_hash_with_text_locator, false>(
+		dataFilesCount, std::move(fileEntries2), conflictEntries2, m_sqpackIndex2Segment3, std::vector<sqindex::path_hash_locator>(), strict);
+	std::ofstream(dir / std::format("{}.win32.index2", DatName), std::ios::binary).write(reinterpret_cast<const char*>(&indexData[0]), indexData.size());
+}
+
+void xivres::sqpack::generator::export_to_files(const std::filesystem::path& dir, bool strict, size_t cores) {
+	const auto dataHeader = make_data_header(strict);
+
+	std::vector<sqdata::header> dataSubheaders;
+
+	const auto entries = take_entries();
+
+	// Entries whose packed data matches one already written are not written again; they point at it afterwards.
+	std::map<sha1_value, entry_info*> duplicateSources;
+	std::vector<std::pair<entry_info*, entry_info*>> duplicates;
 
 	{
 		util::thread_pool::task_waiter<std::pair<size_t, std::vector<char>>> waiter;
 		std::fstream dataFile;
 
+		// Data is hashed as it gets written, so that the file does not have to be read back.
+		util::hash_sha1 dataSha1;
+
+		const auto finalize_data_file = [&] {
+			if (strict) {
+				dataSha1.get_digest_bytes(dataSubheaders.back().DataSha1.Value);
+				dataSubheaders.back().Sha1.set_from_span(reinterpret_cast<char*>(&dataSubheaders.back()), offsetof(sqdata::header, Sha1));
+				dataSha1.reset();
+			}
+
+			dataFile.seekp(0, std::ios::beg);
+			dataFile.write(reinterpret_cast<const char*>(&dataHeader), sizeof dataHeader);
+			dataFile.write(reinterpret_cast<const char*>(&dataSubheaders.back()), sizeof dataSubheaders.back());
+			dataFile.close();
+		};
+
 		for (size_t i = 0;;) {
 			for (; i < entries.size() && waiter.pending() < (std::max<size_t>)(8, 2 * waiter.pool().concurrency()); ++i) {
-				waiter.submit([this, i, entry = entries[i].get()](util::thread_pool::base_task& task) {
+				ProgressCallback(i, entries.size());
+
+				waiter.submit([this, i, entry = entries[i].second.get()](util::thread_pool::base_task& task) {
 					task.throw_if_cancelled();
-					return std::make_pair(i, entry->Provider->read_vector<char>());
+					auto data = entry->Provider->read_vector<char>();
+					if (m_deduplicate) {
+						entry->ContentHash.emplace();
+						entry->ContentHash->set_from_ptr(data.data(), data.size());
+					}
+					return std::make_pair(i, std::move(data));
 				});
-				ProgressCallback(i, entries.size());
 			}
 
 			const auto resultPair = waiter.get();
 			if (!resultPair)
 				break;
 
-			auto& entry = *entries[resultPair->first];
+			auto& entry = *entries[resultPair->first].second;
 			auto& data = resultPair->second;
 			const auto provider{std::move(entry.Provider)};
+			if (entry.ContentHash) {
+				if (const auto [it, inserted] = duplicateSources.emplace(*entry.ContentHash, &entry); !inserted) {
+					duplicates.emplace_back(&entry, it->second);
+					continue;
+				}
+			}
+
 			const auto entrySize = provider->size();
 
 			if (dataSubheaders.empty() ||
 				sizeof header + sizeof(sqdata::header) + dataSubheaders.back().DataSize + entrySize > dataSubheaders.back().MaxFileSize) {
-				if (!dataSubheaders.empty() && dataFile.is_open()) {
-					if (strict) {
-						std::vector<char> buf(65536);
-						util::hash_sha1 sha1;
-						dataFile.seekg(sizeof header + sizeof(sqdata::header), std::ios::beg);
-						align<uint64_t>(dataSubheaders.back().DataSize, buf.size()).iterate_chunks([&](uint64_t index, uint64_t offset, uint64_t size) {
-							dataFile.read(&buf[0], static_cast<size_t>(size));
-							if (!dataFile)
-								throw std::runtime_error("Failed to read from output data file.");
-							sha1.process_bytes(&buf[0], static_cast<size_t>(size));
-						}, sizeof header + sizeof(sqdata::header));
-
-						sha1.get_digest_bytes(dataSubheaders.back().DataSha1.Value);
-						dataSubheaders.back().Sha1.set_from_span(reinterpret_cast<char*>(&dataSubheaders.back()), offsetof(sqdata::header, Sha1));
-					}
-
-					dataFile.seekp(0, std::ios::beg);
-					dataFile.write(reinterpret_cast<const char*>(&dataHeader), sizeof dataHeader);
-					dataFile.write(reinterpret_cast<const char*>(&dataSubheaders.back()), sizeof dataSubheaders.back());
-					dataFile.close();
-				}
+				if (!dataSubheaders.empty() && dataFile.is_open())
+					finalize_data_file();
 
 				dataFile.open(dir / std::format("{}.win32.dat{}", DatName, dataSubheaders.size()), std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
 				dataSubheaders.emplace_back(sqdata::header{
@@ -640,94 +920,436 @@ void xivres::sqpack::generator::export_to_files(const std::filesystem::path& dir
 			dataFile.write(&data[0], static_cast<std::streamsize>(data.size()));
 			if (!dataFile)
 				throw std::runtime_error("Failed to write to output data file.");
+			if (strict)
+				dataSha1.process_bytes(data.data(), data.size());
 
 			dataSubheaders.back().DataSize = dataSubheaders.back().DataSize + entrySize;
 		}
 
-		if (!dataSubheaders.empty() && dataFile.is_open()) {
-			if (strict) {
-				std::vector<char> buf(65536);
-				util::hash_sha1 sha1;
-				dataFile.seekg(sizeof header + sizeof(sqdata::header), std::ios::beg);
-				align<uint64_t>(dataSubheaders.back().DataSize, buf.size()).iterate_chunks([&](uint64_t index, uint64_t offset, uint64_t size) {
-					dataFile.read(&buf[0], static_cast<size_t>(size));
-					if (!dataFile)
-						throw std::runtime_error("Failed to read from output data file.");
-					sha1.process_bytes(&buf[0], static_cast<size_t>(size));
-				}, sizeof header + sizeof(sqdata::header));
-
-				sha1.get_digest_bytes(dataSubheaders.back().DataSha1.Value);
-				dataSubheaders.back().Sha1.set_from_span(reinterpret_cast<char*>(&dataSubheaders.back()), offsetof(sqdata::header, Sha1));
-			}
+		if (!dataSubheaders.empty() && dataFile.is_open())
+			finalize_data_file();
+	}
 
-			dataFile.seekp(0, std::ios::beg);
-			dataFile.write(reinterpret_cast<const char*>(&dataHeader), sizeof dataHeader);
-			dataFile.write(reinterpret_cast<const char*>(&dataSubheaders.back()), sizeof dataSubheaders.back());
-			dataFile.close();
+	resolve_duplicates(entries, duplicates);
+
+	export_index_files(dir, entries, dataSubheaders.size(), strict);
+}
+
+void xivres::sqpack::generator::verify_index_files(const std::filesystem::path& indexPath, std::span<const index_item> index1Items, std::span<const index_item> index2Items) {
+	// Looks every item up the way a reader of a full export of the same entries would, and expects it where it was put.
+	// Items without text cannot be told apart from their synonyms, so those are only checked when they have none.
+	const auto exported = reader::from_path(indexPath);
+	for (const auto& [pathSpec, entry] : index1Items) {
+		const auto locator = exported.Index1.find_data_locator(pathSpec->path_hash(), pathSpec->name_hash());
+		if (locator && locator->IsSynonym && !pathSpec->has_original())
+			continue;
+		if (const auto resolved = exported.find_data_locator_from_index1(*pathSpec); !resolved || !(*resolved == entry->Locator))
+			throw bad_data_error(std::format("{} does not resolve to its data in the exported .index", *pathSpec));
+	}
+	for (const auto& [pathSpec, entry] : index2Items) {
+		const auto locator = exported.Index2.find_data_locator(pathSpec->full_path_hash());
+		if (locator && locator->IsSynonym && !pathSpec->has_original())
+			continue;
+		if (const auto resolved = exported.find_data_locator_from_index2(*pathSpec); !resolved || !(*resolved == entry->Locator))
+			throw bad_data_error(std::format("{} does not resolve to its data in the exported .index2", *pathSpec));
+	}
+}
+
+void xivres::sqpack::generator::resolve_duplicates(const std::vector<std::pair<path_spec, std::unique_ptr<entry_info>>>& entries, std::span<const std::pair<entry_info*, entry_info*>> duplicates) {
+	m_deduplicated.clear();
+	if (duplicates.empty())
+		return;
+
+	std::map<const entry_info*, const path_spec*> pathSpecs;
+	for (const auto& [pathSpec, entry] : entries)
+		pathSpecs.emplace(entry.get(), &pathSpec);
+
+	m_deduplicated.reserve(duplicates.size());
+	for (const auto& [duplicate, source] : duplicates) {
+		duplicate->Locator = source->Locator;
+		m_deduplicated.emplace_back(*pathSpecs.at(duplicate), *pathSpecs.at(source));
+	}
+}
+
+size_t xivres::sqpack::generator::pack_window_size() {
+	return (std::max<size_t>)(64, 4 * util::thread_pool::pool::current().concurrency());
+}
+
+std::vector<uint64_t> xivres::sqpack::generator::resolve_packed_sizes(std::span<entry_info* const> entries, bool hashContent, std::vector<std::vector<char>>& packedData) {
+	// Packed sizes may require packing the entry first, so they are resolved in parallel. Content hashes need the whole
+	// packed data, which is read once here and kept in packedData so that write_entries does not read it again.
+	std::vector<uint64_t> entrySizes(entries.size());
+	packedData.clear();
+	if (hashContent)
+		packedData.resize(entries.size());
+
+	util::thread_pool::task_waiter<size_t> waiter;
+	for (size_t i = 0; i < entries.size(); ++i) {
+		waiter.submit([entry = entries[i], &entrySize = entrySizes[i], data = hashContent ? &packedData[i] : nullptr](util::thread_pool::base_task& task) {
+			task.throw_if_cancelled();
+			if (data) {
+				*data = entry->Provider->read_vector<char>();
+				entry->ContentHash.emplace();
+				entry->ContentHash->set_from_ptr(data->data(), data->size());
+				entrySize = data->size();
+			} else
+				entrySize = static_cast<uint64_t>(entry->Provider->size());
+			return size_t{ 1 };
+		});
+	}
+	while (waiter.get()) {}
+	return entrySizes;
+}
+
+void xivres::sqpack::generator::write_entries(std::span<entry_info* const> entries, std::span<const uint64_t> entrySizes, std::span<std::vector<char>> packedData, const std::vector<std::unique_ptr<preallocated_output_file>>& dataFiles, std::span<const std::unique_ptr<util::hash_sha1>> dataSha1) {
+	// Workers write at their final offsets in any order; only hashing needs the data in file order.
+	util::thread_pool::task_waiter<std::pair<size_t, std::vector<char>>> waiter;
+	std::map<size_t, std::vector<char>> readyEntries;
+	for (size_t nextToSubmit = 0, nextToHash = 0; nextToHash < entries.size();) {
+		for (; nextToSubmit < entries.size() && waiter.pending() + readyEntries.size() < (std::max<size_t>)(8, 2 * waiter.pool().concurrency()); ++nextToSubmit) {
+			waiter.submit([i = nextToSubmit, entry = entries[nextToSubmit], entrySize = entrySizes[nextToSubmit], packedData, &dataFiles, keepData = !dataSha1.empty()](util::thread_pool::base_task& task) {
+				task.throw_if_cancelled();
+				auto data = packedData.empty() ? entry->Provider->read_vector<char>() : std::move(packedData[i]);
+				entry->Provider.reset();
+				if (data.size() != entrySize)
+					throw std::runtime_error("Packed entry size changed between layout and write.");
+
+				dataFiles[entry->Locator.DatFileIndex]->write(entry->Locator.offset(), data.data(), data.size());
+				if (!keepData)
+					data = {};
+				return std::make_pair(i, std::move(data));
+			});
+		}
+
+		readyEntries.emplace(std::move(*waiter.get()));
+		for (auto it = readyEntries.begin(); it != readyEntries.end() && it->first == nextToHash; it = readyEntries.erase(it), ++nextToHash) {
+			if (!dataSha1.empty())
+				dataSha1[entries[nextToHash]->Locator.DatFileIndex]->process_bytes(it->second.data(), it->second.size());
 		}
 	}
+}
 
-	std::vector<sqindex::pair_hash_locator> fileEntries1;
-	std::vector<sqindex::pair_hash_with_text_locator> conflictEntries1;
-	for (const auto& [pairHash, correspondingEntries] : pairHashes) {
-		if (correspondingEntries.size() == 1) {
-			fileEntries1.emplace_back(sqindex::pair_hash_locator{pairHash.second, pairHash.first, correspondingEntries.front()->Locator, 0});
-		} else {
-			fileEntries1.emplace_back(sqindex::pair_hash_locator{pairHash.second, pairHash.first, sqindex::data_locator::Synonym(), 0});
-			uint32_t i = 0;
-			for (const auto& entry : correspondingEntries) {
-				conflictEntries1.emplace_back(sqindex::pair_hash_with_text_locator{
-					.NameHash = pairHash.second,
-					.PathHash = pairHash.first,
-					.Locator = entry->Locator,
-					.ConflictIndex = i++,
+void xivres::sqpack::generator::export_to_files_preallocated(const std::filesystem::path& dir, bool strict) {
+	const auto dataHeader = make_data_header(strict);
+
+	const auto entries = take_entries();
+
+	std::map<sha1_value, entry_info*> duplicateSources;
+	std::vector<std::pair<entry_info*, entry_info*>> duplicates;
+
+	std::vector<sqdata::header> dataSubheaders;
+	std::vector<std::unique_ptr<preallocated_output_file>> dataFiles;
+	std::vector<std::unique_ptr<util::hash_sha1>> dataSha1;
+
+	// Sizing a compressing entry packs it, and the packed data stays in memory until the entry is written. Entries are
+	// therefore sized, laid out and written one window at a time, so at most a window's worth of packed data is held;
+	// the .dat files are grown as each window is laid out instead of being sized once up front.
+	const auto windowSize = pack_window_size();
+	for (size_t next = 0; next < entries.size();) {
+		std::vector<entry_info*> window;
+		for (; next < entries.size() && window.size() < windowSize; ++next)
+			window.emplace_back(entries[next].second.get());
+
+		std::vector<std::vector<char>> packedData;
+		auto entrySizes = resolve_packed_sizes(window, m_deduplicate, packedData);
+		take_duplicates(window, entrySizes, packedData, duplicateSources, duplicates);
+
+		const auto firstTouchedDataFile = dataSubheaders.empty() ? 0 : dataSubheaders.size() - 1;
+		for (size_t i = 0; i < window.size(); ++i) {
+			if (dataSubheaders.empty() ||
+				sizeof header + sizeof(sqdata::header) + dataSubheaders.back().DataSize + entrySizes[i] > dataSubheaders.back().MaxFileSize) {
+				dataSubheaders.emplace_back(sqdata::header{
+					.HeaderSize = sizeof(sqdata::header),
+					.Unknown1 = sqdata::header::Unknown1_Value,
+					.DataSize = 0,
+					.SpanIndex = static_cast<uint32_t>(dataSubheaders.size()),
+					.MaxFileSize = m_maxFileSize,
 				});
-				const auto& path = entryPathSpecs[entry].text();
-				strncpy_s(conflictEntries1.back().FullPath, path.c_str(), path.size());
+				dataFiles.emplace_back(std::make_unique<preallocated_output_file>(
+					dir / std::format("{}.win32.dat{}", DatName, dataFiles.size()),
+					sizeof header + sizeof(sqdata::header),
+					false));
+				if (strict)
+					dataSha1.emplace_back(std::make_unique<util::hash_sha1>());
 			}
+
+			window[i]->Locator = {static_cast<uint32_t>(dataSubheaders.size() - 1), sizeof header + sizeof(sqdata::header) + dataSubheaders.back().DataSize};
+			dataSubheaders.back().DataSize = dataSubheaders.back().DataSize + entrySizes[i];
 		}
+
+		for (auto i = firstTouchedDataFile; i < dataSubheaders.size(); ++i)
+			dataFiles[i]->reserve(sizeof header + sizeof(sqdata::header) + dataSubheaders[i].DataSize);
+
+		write_entries(window, entrySizes, packedData, dataFiles, dataSha1);
+		ProgressCallback(next, entries.size());
 	}
-	conflictEntries1.emplace_back(sqindex::pair_hash_with_text_locator{
-		.NameHash = sqindex::pair_hash_with_text_locator::EndOfList,
-		.PathHash = sqindex::pair_hash_with_text_locator::EndOfList,
-		.Locator = 0,
-		.ConflictIndex = sqindex::pair_hash_with_text_locator::EndOfList,
-	});
 
-	std::vector<sqindex::full_hash_locator> fileEntries2;
-	std::vector<sqindex::full_hash_with_text_locator> conflictEntries2;
-	for (const auto& [fullHash, correspondingEntries] : fullHashes) {
-		if (correspondingEntries.size() == 1) {
-			fileEntries2.emplace_back(sqindex::full_hash_locator{fullHash, correspondingEntries.front()->Locator});
-		} else {
-			fileEntries2.emplace_back(sqindex::full_hash_locator{fullHash, sqindex::data_locator::Synonym()});
-			uint32_t i = 0;
-			for (const auto& entry : correspondingEntries) {
-				conflictEntries2.emplace_back(sqindex::full_hash_with_text_locator{
-					.FullPathHash = fullHash,
-					.UnusedHash = 0,
-					.Locator = entry->Locator,
-					.ConflictIndex = i++,
-				});
-				const auto& path = entryPathSpecs[entry].text();
-				strncpy_s(conflictEntries2.back().FullPath, path.c_str(), path.size());
+	resolve_duplicates(entries, duplicates);
+
+	for (size_t i = 0; i < dataSubheaders.size(); ++i) {
+		if (strict) {
+			dataSha1[i]->get_digest_bytes(dataSubheaders[i].DataSha1.Value);
+			dataSubheaders[i].Sha1.set_from_span(reinterpret_cast<char*>(&dataSubheaders[i]), offsetof(sqdata::header, Sha1));
+		}
+
+		dataFiles[i]->write(0, &dataHeader, sizeof dataHeader);
+		dataFiles[i]->write(sizeof dataHeader, &dataSubheaders[i], sizeof dataSubheaders[i]);
+	}
+	dataFiles.clear();
+
+	export_index_files(dir, entries, dataSubheaders.size(), strict);
+}
+
+void xivres::sqpack::generator::export_to_files_incremental(const std::filesystem::path& dir, bool strict) {
+	static constexpr double MaxUnusedDataRatio = 0.25;
+
+	const auto indexPath = dir / std::format("{}.win32.index", DatName);
+	if (!exists(indexPath))
+		return export_to_files_preallocated(dir, strict);
+
+	const auto dataHeader = make_data_header(strict);
+
+	auto changes = take_entries();
+
+	// Items of the previous index1 and index2 that no change replaces. Deduplicated entries share a locator, and
+	// nothing tells which path hash pair goes with which full path hash among them; the two index files are therefore
+	// carried over separately, each item with its own hashes, locator and, for synonyms, text. This is what a full
+	// export of the same entries would write, and no item is ever paired up with a half of another.
+	std::vector<std::pair<path_spec, entry_info>> keptIndex1Items, keptIndex2Items;
+	std::vector<sqdata::header> dataSubheaders;
+	{
+		// The previous sqpack only needs to be open long enough to read its layout; its files get written to afterwards.
+		const auto previous = reader::from_path(indexPath);
+		if (m_sqpackIndexSegment3.empty())
+			m_sqpackIndexSegment3 = {previous.Index1.segment_3().begin(), previous.Index1.segment_3().end()};
+		if (m_sqpackIndex2Segment3.empty())
+			m_sqpackIndex2Segment3 = {previous.Index2.segment_3().begin(), previous.Index2.segment_3().end()};
+
+		for (const auto& data : previous.Data)
+			dataSubheaders.emplace_back(data.DataHeader);
+
+		std::map<std::pair<uint32_t, uint32_t>, std::vector<const path_spec*>> changedPairHashes;
+		std::map<uint32_t, std::vector<const path_spec*>> changedFullHashes;
+		for (const auto& pathSpec : changes | std::views::keys) {
+			changedPairHashes[std::make_pair(pathSpec.path_hash(), pathSpec.name_hash())].emplace_back(&pathSpec);
+			changedFullHashes[pathSpec.full_path_hash()].emplace_back(&pathSpec);
+		}
+
+		// An item is replaced by a change with the same hash, unless both have text and it differs; that is a synonym.
+		const auto isReplaced = [](const auto& changedHashes, const auto& hash, const path_spec& pathSpec) {
+			const auto it = changedHashes.find(hash);
+			return it != changedHashes.end() && std::ranges::any_of(it->second, [&pathSpec](const path_spec* changed) {
+				return !changed->has_original() || !pathSpec.has_original() || path_spec::FullPathComparator::compare(*changed, pathSpec) == 0;
+			});
+		};
+
+		for (const auto& item : previous.Index1.hash_locators()) {
+			if (item.Locator.IsSynonym)
+				continue;
+			path_spec pathSpec(item.PathHash, item.NameHash, path_spec::EmptyHashValue, previous.CategoryId, previous.ExpacId, previous.PartId);
+			if (!isReplaced(changedPairHashes, std::make_pair(item.PathHash, item.NameHash), pathSpec))
+				keptIndex1Items.emplace_back(std::move(pathSpec), entry_info{0, item.Locator});
+		}
+		for (const auto& item : previous.Index1.text_locators()) {
+			if (item.end_of_list())
+				break;
+			path_spec pathSpec(item.FullPath);
+			if (!isReplaced(changedPairHashes, std::make_pair(item.PathHash, item.NameHash), pathSpec))
+				keptIndex1Items.emplace_back(std::move(pathSpec), entry_info{0, item.Locator});
+		}
+
+		for (const auto& item : previous.Index2.hash_locators()) {
+			if (item.Locator.IsSynonym)
+				continue;
+			path_spec pathSpec(path_spec::EmptyHashValue, path_spec::EmptyHashValue, item.FullPathHash, previous.CategoryId, previous.ExpacId, previous.PartId);
+			if (!isReplaced(changedFullHashes, item.FullPathHash, pathSpec))
+				keptIndex2Items.emplace_back(std::move(pathSpec), entry_info{0, item.Locator});
+		}
+		for (const auto& item : previous.Index2.text_locators()) {
+			if (item.end_of_list())
+				break;
+			path_spec pathSpec(item.FullPath);
+			if (!isReplaced(changedFullHashes, item.FullPathHash, pathSpec))
+				keptIndex2Items.emplace_back(std::move(pathSpec), entry_info{0, item.Locator});
+		}
+
+		// Space of replaced entries is never reused. Past a point the .dat files are mostly unused space, and only a full
+		// export into another directory can compact them; refuse before anything has been written.
+		std::set<sqindex::data_locator> keptLocators;
+		for (const auto& entry : keptIndex1Items | std::views::values)
+			keptLocators.emplace(entry.Locator);
+		for (const auto& entry : keptIndex2Items | std::views::values)
+			keptLocators.emplace(entry.Locator);
+
+		const auto metadata = previous.scan_metadata();
+		uint64_t usedSize = 0, dataSize = 0;
+		for (size_t i = 0; i < previous.Entries.size(); ++i) {
+			// Deduplicated entries are next to each other, and take space only once.
+			if ((i == 0 || !(previous.Entries[i - 1].Locator == previous.Entries[i].Locator)) && keptLocators.contains(previous.Entries[i].Locator))
+				usedSize += metadata.PackedSize[i];
+		}
+		for (const auto& data : previous.Data)
+			dataSize += data.DataHeader.DataSize;
+
+		if (const auto unusedSize = dataSize > usedSize ? dataSize - usedSize : 0; static_cast<double>(unusedSize) > MaxUnusedDataRatio * static_cast<double>(dataSize))
+			throw std::runtime_error(std::format("{} of {} bytes in the .dat files would be left unused; export to another directory instead", unusedSize, dataSize));
+	}
+
+	std::map<sha1_value, entry_info*> duplicateSources;
+	std::vector<std::pair<entry_info*, entry_info*>> duplicates;
+
+	// Only .dat files the previous index knows about hold data worth keeping; anything past them is created anew,
+	// even if a file by that name was left behind by an earlier, larger export.
+	const auto previousDataCount = dataSubheaders.size();
+	std::vector<bool> touchedDataFiles(dataSubheaders.size());
+	std::vector<std::unique_ptr<preallocated_output_file>> dataFiles(dataSubheaders.size());
+
+	// A SHA-1 cannot be resumed from its digest, so in strict mode the data already in a .dat file has to be hashed
+	// again, once, before anything is appended to it. Appended data is hashed as it gets written, and .dat files
+	// without changes are neither read nor rewritten.
+	std::vector<std::unique_ptr<util::hash_sha1>> dataSha1;
+	if (strict)
+		dataSha1.resize(dataSubheaders.size());
+
+	std::vector<uint64_t> previousFileSizes, previousDataSizes;
+	for (size_t i = 0; i < previousDataCount; ++i) {
+		previousFileSizes.emplace_back(file_size(dir / std::format("{}.win32.dat{}", DatName, i)));
+		previousDataSizes.emplace_back(dataSubheaders[i].DataSize);
+	}
+
+	try {
+		// Sized, laid out and written one window at a time to bound the packed data held in memory; see
+		// export_to_files_preallocated.
+		const auto windowSize = pack_window_size();
+		for (size_t next = 0; next < changes.size();) {
+			std::vector<entry_info*> window;
+			for (; next < changes.size() && window.size() < windowSize; ++next)
+				window.emplace_back(changes[next].second.get());
+
+			std::vector<std::vector<char>> packedData;
+			auto entrySizes = resolve_packed_sizes(window, m_deduplicate, packedData);
+			take_duplicates(window, entrySizes, packedData, duplicateSources, duplicates);
+
+			// Changed entries are only ever appended. Data the previous index points at is never overwritten, so the
+			// previous sqpack stays intact until the new index files replace the old ones at the very end.
+			for (size_t k = 0; k < window.size(); ++k) {
+				if (dataSubheaders.empty() ||
+					sizeof header + sizeof(sqdata::header) + dataSubheaders.back().DataSize + entrySizes[k] > dataSubheaders.back().MaxFileSize) {
+					if (dataSubheaders.size() == reader::MaxDataFileCount)
+						throw std::runtime_error(std::format("Changes do not fit in {} .dat files; export to another directory instead", reader::MaxDataFileCount));
+					dataSubheaders.emplace_back(sqdata::header{
+						.HeaderSize = sizeof(sqdata::header),
+						.Unknown1 = sqdata::header::Unknown1_Value,
+						.DataSize = 0,
+						.SpanIndex = static_cast<uint32_t>(dataSubheaders.size()),
+						.MaxFileSize = m_maxFileSize,
+					});
+					touchedDataFiles.emplace_back(true);
+					dataFiles.emplace_back();
+					if (strict)
+						dataSha1.emplace_back(std::make_unique<util::hash_sha1>());
+				}
+
+				window[k]->Locator = {static_cast<uint32_t>(dataSubheaders.size() - 1), sizeof header + sizeof(sqdata::header) + dataSubheaders.back().DataSize};
+				dataSubheaders.back().DataSize = dataSubheaders.back().DataSize + entrySizes[k];
+				touchedDataFiles[window[k]->Locator.DatFileIndex] = true;
 			}
+
+			if (strict) {
+				util::thread_pool::task_waiter<size_t> waiter;
+				for (size_t i = 0; i < previousDataCount; ++i) {
+					if (!touchedDataFiles[i] || dataSha1[i])
+						continue;
+
+					dataSha1[i] = std::make_unique<util::hash_sha1>();
+					waiter.submit([&hasher = *dataSha1[i], dataPath = dir / std::format("{}.win32.dat{}", DatName, i), dataSize = previousDataSizes[i]](util::thread_pool::base_task& task) {
+						const auto dataFile = file_stream(dataPath);
+						std::vector<char> buf(1048576);
+						for (uint64_t offset = sizeof header + sizeof(sqdata::header), to = offset + dataSize; offset < to;) {
+							task.throw_if_cancelled();
+							const auto read = dataFile.read(static_cast<std::streamoff>(offset), buf.data(), static_cast<std::streamsize>((std::min<uint64_t>)(buf.size(), to - offset)));
+							if (read <= 0)
+								throw std::runtime_error("Failed to read back output data file.");
+							hasher.process_bytes(buf.data(), static_cast<size_t>(read));
+							offset += static_cast<uint64_t>(read);
+						}
+						return size_t{ 1 };
+					});
+				}
+				while (waiter.get()) {}
+			}
+
+			for (size_t i = 0; i < dataSubheaders.size(); ++i) {
+				if (!touchedDataFiles[i])
+					continue;
+
+				const auto fileSize = sizeof header + sizeof(sqdata::header) + dataSubheaders[i].DataSize;
+				if (dataFiles[i])
+					dataFiles[i]->reserve(fileSize);
+				else
+					dataFiles[i] = std::make_unique<preallocated_output_file>(dir / std::format("{}.win32.dat{}", DatName, i), fileSize, i < previousDataCount);
+			}
+
+			write_entries(window, entrySizes, packedData, dataFiles, dataSha1);
+			ProgressCallback(next, changes.size());
 		}
+	} catch (...) {
+		// The previous index is still the one in place; put the .dat files back the way it left them.
+		dataFiles.clear();
+		for (size_t i = 0; i < touchedDataFiles.size(); ++i) {
+			if (!touchedDataFiles[i])
+				continue;
+
+			std::error_code ec;
+			const auto dataPath = dir / std::format("{}.win32.dat{}", DatName, i);
+			if (i < previousDataCount)
+				resize_file(dataPath, previousFileSizes[i], ec);
+			else
+				remove(dataPath, ec);
+		}
+		throw;
 	}
-	conflictEntries2.emplace_back(sqindex::full_hash_with_text_locator{
-		.FullPathHash = sqindex::full_hash_with_text_locator::EndOfList,
-		.UnusedHash = sqindex::full_hash_with_text_locator::EndOfList,
-		.Locator = 0,
-		.ConflictIndex = sqindex::full_hash_with_text_locator::EndOfList,
-	});
 
-	auto indexData = export_index_file_data<sqindex::sqindex_type::Index, sqindex::pair_hash_locator, sqindex::pair_hash_with_text_locator, true>(
-		dataSubheaders.size(), std::move(fileEntries1), conflictEntries1, m_sqpackIndexSegment3, std::vector<sqindex::path_hash_locator>(), strict);
-	std::ofstream(dir / std::format("{}.win32.index", DatName), std::ios::binary).write(reinterpret_cast<const char*>(&indexData[0]), indexData.size());
+	resolve_duplicates(changes, duplicates);
 
-	indexData = export_index_file_data<sqindex::sqindex_type::Index, sqindex::full_hash_locator, sqindex::full_hash_with_text_locator, false>(
-		dataSubheaders.size(), std::move(fileEntries2), conflictEntries2, m_sqpackIndex2Segment3, std::vector<sqindex::path_hash_locator>(), strict);
-	std::ofstream(dir / std::format("{}.win32.index2", DatName), std::ios::binary).write(reinterpret_cast<const char*>(&indexData[0]), indexData.size());
+	dataFiles.clear();
+
+	for (size_t i = 0; i < dataSubheaders.size(); ++i) {
+		if (!touchedDataFiles[i])
+			continue;
+
+		const auto dataPath = dir / std::format("{}.win32.dat{}", DatName, i);
+		if (strict) {
+			dataSha1[i]->get_digest_bytes(dataSubheaders[i].DataSha1.Value);
+			dataSubheaders[i].Sha1.set_from_span(reinterpret_cast<char*>(&dataSubheaders[i]), offsetof(sqdata::header, Sha1));
+		} else {
+			dataSubheaders[i].DataSha1 = {};
+			dataSubheaders[i].Sha1 = {};
+		}
+
+		std::fstream dataFile(dataPath, std::ios::binary | std::ios::in | std::ios::out);
+		dataFile.write(reinterpret_cast<const char*>(&dataHeader), sizeof dataHeader);
+		dataFile.write(reinterpret_cast<const char*>(&dataSubheaders[i]), sizeof dataSubheaders[i]);
+		if (!dataFile)
+			throw std::runtime_error("Failed to write to output data file.");
+	}
+
+	std::vector<index_item> index1Items, index2Items;
+	index1Items.reserve(keptIndex1Items.size() + changes.size());
+	index2Items.reserve(keptIndex2Items.size() + changes.size());
+	for (const auto& [pathSpec, entry] : keptIndex1Items)
+		index1Items.emplace_back(&pathSpec, &entry);
+	for (const auto& [pathSpec, entry] : keptIndex2Items)
+		index2Items.emplace_back(&pathSpec, &entry);
+	for (const auto& [pathSpec, entry] : changes) {
+		index1Items.emplace_back(&pathSpec, entry.get());
+		index2Items.emplace_back(&pathSpec, entry.get());
+	}
+
+	export_index_files(dir, index1Items, index2Items, dataSubheaders.size(), strict);
+
+	if (strict)
+		verify_index_files(indexPath, index1Items, index2Items);
 }
 
 std::unique_ptr<xivres::default_base_stream> xivres::sqpack::generator::get(const path_spec& pathSpec) const {
@@ -0,0 +1,282 @@
+#include "../include/xivres/sqpack.path_resolver.h"
+
+#include <charconv>
+
+#include "../include/xivres/util.crc32.h"
+#include "../include/xivres/util.thread_pool.h"
+
+namespace {
+	struct pattern_segment {
+		std::vector<std::string> Values;
+
+		// Set on segments that repeat the value chosen by an earlier segment.
+		size_t SourceSegment = SIZE_MAX;
+	};
+
+	struct parsed_pattern {
+		std::vector<pattern_segment> Segments;
+
+		// Index of the first segment of the file name; 0 if the pattern has no folder.
+		size_t NameBegin = 0;
+	};
+
+	std::vector<std::string> parse_placeholder_values(std::string_view body) {
+		std::vector<std::string> values;
+		if (const auto dash = body.find('-'); dash != std::string_view::npos && body.find(',') == std::string_view::npos) {
+			const auto lo = body.substr(0, dash);
+			const auto hi = body.substr(dash + 1);
+			uint64_t from{}, to{};
+			if (lo.empty() || hi.empty()
+				|| std::from_chars(lo.data(), lo.data() + lo.size(), from).ptr != lo.data() + lo.size()
+				|| std::from_chars(hi.data(), hi.data() + hi.size(), to).ptr != hi.data() + hi.size()
+				|| from > to)
+				throw std::invalid_argument(std::format("invalid range placeholder {{{}}}", body));
+
+			values.reserve(static_cast<size_t>(to - from + 1));
+			for (auto i = from; i <= to; ++i)
+				values.emplace_back(std::format("{:0{}}", i, lo.size()));
+			return values;
+		}
+
+		for (size_t offset = 0; offset <= body.size();) {
+			auto next = body.find(',', offset);
+			if (next == std::string_view::npos)
+				next = body.size();
+			values.emplace_back(body.substr(offset, next - offset));
+			offset = next + 1;
+		}
+		return values;
+	}
+
+	parsed_pattern parse_pattern(std::string_view pattern, const std::map<std::string, std::vector<std::string>, std::less<>>& variables) {
+		parsed_pattern res;
+		std::map<std::string, size_t, std::less<>> namedSegments;
+
+		const auto add_placeholder = [&](std::vector<std::string> values) {
+			for (const auto& value : values) {
+				if (value.find_first_of("/\\") != std::string::npos)
+					throw std::invalid_argument("placeholders may not expand to slashes");
+			}
+			res.Segments.emplace_back().Values = std::move(values);
+		};
+
+		const auto parse_part = [&](std::string_view part) {
+			for (size_t offset = 0; offset < part.size();) {
+				const auto open = part.find('{', offset);
+				if (open != offset)
+					res.Segments.emplace_back().Values.emplace_back(part.substr(offset, open == std::string_view::npos ? std::string_view::npos : open - offset));
+				if (open == std::string_view::npos)
+					break;
+
+				const auto close = part.find('}', open);
+				if (close == std::string_view::npos)
+					throw std::invalid_argument("unterminated placeholder");
+
+				auto body = part.substr(open + 1, close - open - 1);
+				offset = close + 1;
+
+				std::string_view name;
+				if (const auto eq = body.find('='); eq != std::string_view::npos) {
+					name = body.substr(0, eq);
+					body = body.substr(eq + 1);
+
+				} else if (body.find_first_of(",-") == std::string_view::npos) {
+					if (const auto it = namedSegments.find(body); it != namedSegments.end()) {
+						res.Segments.emplace_back().SourceSegment = it->second;
+						continue;
+					}
+
+					const auto it = variables.find(body);
+					if (it == variables.end())
+						throw std::invalid_argument(std::format("unknown placeholder {{{}}}", body));
+
+					add_placeholder(it->second);
+					namedSegments.emplace(body, res.Segments.size() - 1);
+					continue;
+				}
+
+				add_placeholder(parse_placeholder_values(body));
+				if (!name.empty() && !namedSegments.emplace(name, res.Segments.size() - 1).second)
+					throw std::invalid_argument(std::format("placeholder {} is defined twice", name));
+			}
+		};
+
+		if (const auto lastSlash = pattern.rfind('/'); lastSlash == std::string_view::npos) {
+			parse_part(pattern);
+		} else {
+			if (pattern.find('}', lastSlash) < pattern.find('{', lastSlash))
+				throw std::invalid_argument("placeholders may not contain slashes");
+			parse_part(pattern.substr(0, lastSlash));
+			res.NameBegin = res.Segments.size();
+			parse_part(pattern.substr(lastSlash + 1));
+		}
+
+		return res;
+	}
+
+	class pattern_expander {
+		const xivres::sqpack::path_resolver& m_resolver;
+		const parsed_pattern& m_pattern;
+		xivres::util::thread_pool::base_task& m_task;
+		const size_t m_splitSegment;
+		const size_t m_splitBegin;
+		const size_t m_splitEnd;
+
+		std::vector<size_t> m_chosen;
+		std::string m_text;
+		std::vector<xivres::path_spec> m_found;
+
+	public:
+		pattern_expander(const xivres::sqpack::path_resolver& resolver, const parsed_pattern& pattern, xivres::util::thread_pool::base_task& task, size_t splitSegment, size_t splitBegin, size_t splitEnd)
+			: m_resolver(resolver)
+			, m_pattern(pattern)
+			, m_task(task)
+			, m_splitSegment(splitSegment)
+			, m_splitBegin(splitBegin)
+			, m_splitEnd(splitEnd)
+			, m_chosen(pattern.Segments.size()) {
+		}
+
+		std::vector<xivres::path_spec> run() {
+			expand(0, 0, 0, 0);
+			return std::move(m_found);
+		}
+
+	private:
+		// CRCs are carried in zlib's convention, so that each prefix is hashed only once for all of its expansions.
+		void expand(size_t segmentIndex, uint32_t pathCrc, uint32_t nameCrc, uint32_t fullPathCrc) {
+			if (segmentIndex != m_pattern.NameBegin || segmentIndex == 0)
+				return expand_segment(segmentIndex, pathCrc, nameCrc, fullPathCrc);
+
+			// The folder is complete; skip every name under it unless some entry lives there.
+			if (!m_resolver.contains_path_hash(~pathCrc))
+				return;
+
+			m_text.push_back('/');
+			expand_segment(segmentIndex, pathCrc, nameCrc, xivres::util::crc32_update(pathCrc, "/"));
+			m_text.pop_back();
+		}
+
+		void expand_segment(size_t segmentIndex, uint32_t pathCrc, uint32_t nameCrc, uint32_t fullPathCrc) {
+			if (segmentIndex == m_pattern.Segments.size()) {
+				if (m_resolver.contains(m_pattern.NameBegin ? ~pathCrc : xivres::path_spec::EmptyHashValue, ~nameCrc, ~fullPathCrc))
+					m_found.emplace_back(m_text);
+				return;
+			}
+
+			const auto& segment = m_pattern.Segments[segmentIndex];
+			const auto& source = segment.SourceSegment == SIZE_MAX ? segment : m_pattern.Segments[segment.SourceSegment];
+			size_t from = 0, to = source.Values.size();
+			if (segment.SourceSegment != SIZE_MAX) {
+				from = m_chosen[segment.SourceSegment];
+				to = from + 1;
+			} else if (segmentIndex == m_splitSegment) {
+				from = m_splitBegin;
+				to = m_splitEnd;
+			}
+
+			const auto textLength = m_text.size();
+			for (auto i = from; i < to; ++i) {
+				m_task.throw_if_cancelled();
+
+				const auto& value = source.Values[i];
+				m_chosen[segmentIndex] = i;
+				m_text.append(value);
+				if (segmentIndex < m_pattern.NameBegin)
+					expand(segmentIndex + 1, xivres::util::crc32_update_path(pathCrc, value), nameCrc, fullPathCrc);
+				else
+					expand(segmentIndex + 1, pathCrc, xivres::util::crc32_update_path(nameCrc, value), xivres::util::crc32_update_path(fullPathCrc, value));
+				m_text.resize(textLength);
+			}
+		}
+	};
+}
+
+xivres::sqpack::path_resolver::path_resolver(const reader& reader, bool unresolvedOnly) {
+	// Entries sharing a locator were deduplicated, and the reader pairs up their hashes arbitrarily; any pair hash of
+	// such a group is taken to go with any of its full path hashes.
+	for (auto runBegin = reader.Entries.begin(); runBegin != reader.Entries.end();) {
+		auto runEnd = std::next(runBegin);
+		while (runEnd != reader.Entries.end() && runEnd->Locator == runBegin->Locator)
+			++runEnd;
+
+		const auto run = std::ranges::subrange(runBegin, runEnd);
+		runBegin = runEnd;
+		if (unresolvedOnly && std::ranges::all_of(run, [](const auto& entry) { return entry.PathSpec.has_original(); }))
+			continue;
+
+		for (const auto& entry : run) {
+			const auto hasPair = entry.PathSpec.path_hash() != path_spec::EmptyHashValue;
+			const auto hasFull = entry.PathSpec.full_path_hash() != path_spec::EmptyHashValue;
+			const auto pairHash = (static_cast<uint64_t>(entry.PathSpec.path_hash()) << 32) | entry.PathSpec.name_hash();
+
+			if (hasPair)
+				m_pathHashes.push_back(entry.PathSpec.path_hash());
+
+			if (hasPair && hasFull) {
+				for (const auto& other : run) {
+					if (other.PathSpec.full_path_hash() != path_spec::EmptyHashValue)
+						m_entryHashes.emplace_back(pairHash, other.PathSpec.full_path_hash());
+				}
+			} else if (hasPair) {
+				m_pairOnlyHashes.push_back(pairHash);
+			} else if (hasFull) {
+				m_fullPathOnlyHashes.push_back(entry.PathSpec.full_path_hash());
+			}
+		}
+	}
+
+	const auto sort_unique = [](auto& v) {
+		std::ranges::sort(v);
+		v.erase(std::ranges::unique(v).begin(), v.end());
+	};
+	sort_unique(m_pathHashes);
+	sort_unique(m_entryHashes);
+	sort_unique(m_pairOnlyHashes);
+	sort_unique(m_fullPathOnlyHashes);
+}
+
+bool xivres::sqpack::path_resolver::contains_path_hash(uint32_t pathHash) const {
+	// Without .index, there are no folder hashes to prune with.
+	return m_pathHashes.empty() || std::ranges::binary_search(m_pathHashes, pathHash);
+}
+
+bool xivres::sqpack::path_resolver::contains(uint32_t pathHash, uint32_t nameHash, uint32_t fullPathHash) const {
+	const auto pairHash = (static_cast<uint64_t>(pathHash) << 32) | nameHash;
+	return std::ranges::binary_search(m_entryHashes, std::make_pair(pairHash, fullPathHash))
+		|| std::ranges::binary_search(m_pairOnlyHashes, pairHash)
+		|| std::ranges::binary_search(m_fullPathOnlyHashes, fullPathHash);
+}
+
+std::vector<xivres::path_spec> xivres::sqpack::path_resolver::resolve(std::string_view pattern) const {
+	const auto parsed = parse_pattern(pattern, Variables);
+
+	util::thread_pool::task_waiter<std::vector<path_spec>> waiter;
+
+	// Work is divided along the first placeholder that has more than one value.
+	auto splitSegment = SIZE_MAX;
+	size_t splitCount = 1, splitValueCount = 1;
+	for (size_t i = 0; i < parsed.Segments.size(); ++i) {
+		const auto& segment = parsed.Segments[i];
+		if (segment.SourceSegment == SIZE_MAX && segment.Values.size() > 1) {
+			splitSegment = i;
+			splitValueCount = segment.Values.size();
+			splitCount = (std::min)(splitValueCount, 4 * waiter.pool().concurrency());
+			break;
+		}
+	}
+
+	for (size_t i = 0; i < splitCount; ++i) {
+		const auto splitBegin = splitValueCount * i / splitCount;
+		const auto splitEnd = splitValueCount * (i + 1) / splitCount;
+		waiter.submit([this, &parsed, splitSegment, splitBegin, splitEnd](util::thread_pool::base_task& task) {
+			return pattern_expander(*this, parsed, task, splitSegment, splitBegin, splitEnd).run();
+		});
+	}
+
+	std::vector<path_spec> res;
+	while (auto found = waiter.get())
+		std::ranges::move(*found, std::back_inserter(res));
+	std::ranges::sort(res, path_spec::FullPathComparator());
+	return res;
+}
@@ -1,5 +1,88 @@
 #include "../include/xivres/sqpack.reader.h"
 
+namespace {
+	// Sorts equal slices concurrently, and then merges neighbouring runs pairwise until there is one left.
+	template<typename T, typename TComparator>
+	void parallel_sort(std::vector<T>& items, const TComparator& comparator) {
+		static constexpr size_t MinItemsPerChunk = 16384;
+		auto& pool = xivres::util::thread_pool::pool::current();
+		const auto chunkCount = (std::min<size_t>)(pool.concurrency(), items.size() / MinItemsPerChunk);
+		if (chunkCount < 2) {
+			std::sort(items.begin(), items.end(), comparator);
+			return;
+		}
+
+		std::vector<size_t> bounds(chunkCount + 1);
+		for (size_t i = 0; i <= chunkCount; ++i)
+			bounds[i] = items.size() * i / chunkCount;
+
+		{
+			xivres::util::thread_pool::task_waiter<bool> waiter(pool);
+			for (size_t i = 0; i < chunkCount; ++i) {
+				waiter.submit([&items, &comparator, first = bounds[i], last = bounds[i + 1]](xivres::util::thread_pool::base_task&) {
+					std::sort(items.begin() + first, items.begin() + last, comparator);
+					return true;
+				});
+			}
+			waiter.wait_all();
+		}
+
+		for (size_t width = 1; width < chunkCount; width *= 2) {
+			xivres::util::thread_pool::task_waiter<bool> waiter(pool);
+			for (size_t i = 0; i + width < chunkCount; i += width * 2) {
+				waiter.submit([&items, &comparator, first = bounds[i], middle = bounds[i + width], last = bounds[(std::min)(i + width * 2, chunkCount)]](xivres::util::thread_pool::base_task&) {
+					std::inplace_merge(items.begin() + first, items.begin() + middle, items.begin() + last, comparator);
+					return true;
+				});
+			}
+			waiter.wait_all();
+		}
+	}
+
+	// Fills row of table from the packed file header at the beginning of head; head must cover the whole header.
+	void read_entry_metadata(std::span<const uint8_t> head, xivres::sqpack::reader::metadata_table& table, size_t row) {
+		using namespace xivres;
+
+		packed::file_header header;
+		std::memcpy(&header, head.data(), sizeof header);
+
+		uint32_t blockCount = 0;
+		switch (header.Type) {
+			case packed::type::none:
+			case packed::type::placeholder:
+				break;
+
+			case packed::type::standard:
+				blockCount = header.BlockCountOrVersion;
+				break;
+
+			case packed::type::texture: {
+				if (sizeof header + 1ULL * header.BlockCountOrVersion * sizeof(packed::mipmap_block_locator) > head.size())
+					return;
+				for (const auto& locator : util::span_cast<packed::mipmap_block_locator>(head, sizeof header, header.BlockCountOrVersion))
+					blockCount += locator.BlockCount;
+				break;
+			}
+
+			case packed::type::model: {
+				if (sizeof header + sizeof(packed::model_block_locator) > head.size())
+					return;
+				const auto& locator = util::span_cast<packed::model_block_locator>(head, sizeof header, 1)[0];
+				blockCount = locator.FirstBlockIndices.Index[2] + locator.BlockCount.Index[2];
+				break;
+			}
+
+			default:
+				return;
+		}
+
+		table.Type[row] = header.Type;
+		table.DecompressedSize[row] = header.DecompressedSize;
+		table.BlockCount[row] = blockCount;
+		table.PackedSize[row] = header.occupied_size();
+	}
+}
+
 std::span<const xivres::sqpack::sqindex::path_hash_locator> xivres::sqpack::reader::sqindex_1_type::pair_hash_locators() const {
 	return util::span_cast<sqindex::path_hash_locator>(Data, index_header().PathHashLocatorSegment.Offset, index_header().PathHashLocatorSegment.Size, 1);
 }
@@ -38,21 +121,31 @@ const xivres::sqpack::sqindex::data_locator& xivres::sqpack::reader::sqindex_1_t
 	throw std::out_of_range(std::format("NameHash {:08x} in PathHash {:08x} not found", nameHash, pathHash));
 }
 
+void xivres::sqpack::reader::sqindex_1_type::submit_verification(util::thread_pool::task_waiter<bool>& waiter) const {
+	sqindex_type::submit_verification(waiter);
+	if (index_header().PathHashLocatorSegment.Size % sizeof(sqindex::path_hash_locator))
+		throw bad_data_error("PathHashLocators has an invalid size alignment");
+	waiter.submit([this](util::thread_pool::base_task&) {
+		index_header().PathHashLocatorSegment.Sha1.verify(pair_hash_locators(), "PathHashLocatorSegment has invalid data SHA-1");
+		return true;
+	});
+}
+
 xivres::sqpack::reader::sqindex_1_type::sqindex_1_type(std::vector<uint8_t> data, bool strictVerify)
-	: sqindex_type<sqindex::pair_hash_locator, sqindex::pair_hash_with_text_locator>(std::move(data), strictVerify) {
+	: sqindex_type<sqindex::pair_hash_locator, sqindex::pair_hash_with_text_locator>(std::move(data), false) {
 	if (strictVerify) {
-		if (index_header().PathHashLocatorSegment.Size % sizeof(sqindex::path_hash_locator))
-			throw bad_data_error("PathHashLocators has an invalid size alignment");
-		index_header().PathHashLocatorSegment.Sha1.verify(pair_hash_locators(), "PathHashLocatorSegment has invalid data SHA-1");
+		util::thread_pool::task_waiter<bool> waiter;
+		submit_verification(waiter);
+		waiter.wait_all();
 	}
 }
 
 xivres::sqpack::reader::sqindex_1_type::sqindex_1_type(const stream& strm, bool strictVerify)
-	: sqindex_type<sqindex::pair_hash_locator, sqindex::pair_hash_with_text_locator>(strm, strictVerify) {
+	: sqindex_type<sqindex::pair_hash_locator, sqindex::pair_hash_with_text_locator>(strm, false) {
 	if (strictVerify) {
-		if (index_header().PathHashLocatorSegment.Size % sizeof(sqindex::path_hash_locator))
-			throw bad_data_error("PathHashLocators has an invalid size alignment");
-		index_header().PathHashLocatorSegment.Sha1.verify(pair_hash_locators(), "PathHashLocatorSegment has invalid data SHA-1");
+		util::thread_pool::task_waiter<bool> waiter;
+		submit_verification(waiter);
+		waiter.wait_all();
 	}
 }
 
@@ -91,11 +184,18 @@ xivres::sqpack::reader::sqdata_type::sqdata_type(std::shared_ptr<stream> strm, c
 }
 
 xivres::sqpack::reader::reader(const std::string& fileName, const stream& indexStream1, const stream& indexStream2, std::vector<std::shared_ptr<stream>> dataStreams, bool strictVerify)
-	: Index1(indexStream1, strictVerify)
-	, Index2(indexStream2, strictVerify)
+	: Index1(indexStream1, false)
+	, Index2(indexStream2, false)
 	, CategoryId(static_cast<uint8_t>(std::strtol(fileName.substr(0, 2).c_str(), nullptr, 16)))
 	, ExpacId(static_cast<uint8_t>(std::strtol(fileName.substr(2, 2).c_str(), nullptr, 16)))
 	, PartId(static_cast<uint8_t>(std::strtol(fileName.substr(4, 2).c_str(), nullptr, 16))) {
+	// Segment SHA-1 checks run in the background while the entries are being built, and get collected at the end.
+	util::thread_pool::task_waiter<bool> verifier;
+	if (strictVerify) {
+		Index1.submit_verification(verifier);
+		Index2.submit_verification(verifier);
+	}
+
 	std::vector<std::pair<sqindex::data_locator, std::tuple<uint32_t, uint32_t, const char*>>> offsets1;
 	offsets1.reserve(
 		(std::max)(Index1.hash_locators().size() + Index1.text_locators().size(), Index2.hash_locators().size() + Index2.text_locators().size())
@@ -161,89 +261,108 @@ xivres::sqpack::reader::reader(const std::string& fileName, const stream& indexS
 		}
 	};
 
-	std::sort(offsets1.begin(), offsets1.end(), Comparator());
-	std::sort(offsets2.begin(), offsets2.end(), Comparator());
-	Entries.reserve(offsets1.size());
+	{
+		util::thread_pool::task_waiter<bool> waiter;
+		waiter.submit([&offsets1](util::thread_pool::base_task&) {
+			parallel_sort(offsets1, Comparator());
+			return true;
+		});
+		waiter.submit([&offsets2](util::thread_pool::base_task&) {
+			parallel_sort(offsets2, Comparator());
+			return true;
+		});
+		waiter.wait_all();
+	}
 
-	if (strictVerify && !offsets1.empty() && !offsets2.empty()) {
-		for (size_t i = 0; i < offsets1.size(); ++i) {
-			if (offsets1[i].first != offsets2[i].first)
-				throw bad_data_error(".index and .index2 have items with different locators");
-			if (offsets1[i].first.IsSynonym)
-				throw bad_data_error("Synonym remains after conflict resolution");
-		}
+	const auto hasIndex1 = !offsets1.empty();
+	const auto hasIndex2 = !offsets2.empty();
+	const auto offsetCount = hasIndex1 ? offsets1.size() : offsets2.size();
+	const auto locatorAt = [&](size_t i) -> const sqindex::data_locator& {
+		return hasIndex1 ? offsets1[i].first : offsets2[i].first;
+	};
+
+	if (strictVerify && hasIndex1 && hasIndex2) {
+		if (offsets1.back().first != offsets2.back().first)
+			throw bad_data_error(".index and .index2 have items with different locators");
+		if (offsets1.back().first.IsSynonym)
+			throw bad_data_error("Synonym remains after conflict resolution");
 	}
 
-	path_spec pathSpec;
-	if (!offsets1.empty() && !offsets2.empty()) {
-		for (size_t curr = 1, prev = 0; curr < offsets1.size(); ++curr, ++prev) {
+	// Builds the entries whose locator is at [from, to) of the sorted offsets; the item at to is only looked at to compute the allocation.
+	const auto buildEntries = [&](size_t from, size_t to) {
+		std::vector<entry_info> entries;
+		entries.reserve(to - from);
+		for (size_t prev = from, curr = from + 1; prev < to; ++prev, ++curr) {
+			if (strictVerify && hasIndex1 && hasIndex2) {
+				if (offsets1[prev].first != offsets2[prev].first)
+					throw bad_data_error(".index and .index2 have items with different locators");
+				if (offsets1[prev].first.IsSynonym)
+					throw bad_data_error("Synonym remains after conflict resolution");
+			}
 
 			// Skip dummy items to mark end of individual .dat file.
-			if (offsets1[prev].first.DatFileIndex != offsets1[curr].first.DatFileIndex)
+			if (locatorAt(prev).DatFileIndex != locatorAt(curr).DatFileIndex)
 				continue;
 
-			Entries.emplace_back(entry_info{.Locator = offsets1[prev].first, .Allocation = offsets1[curr].first.offset() - offsets1[prev].first.offset()});
-			if (std::get<2>(offsets1[prev].second))
-				Entries.back().PathSpec = path_spec(std::get<2>(offsets1[prev].second));
-			else if (std::get<1>(offsets2[prev].second))
-				Entries.back().PathSpec = path_spec(std::get<1>(offsets2[prev].second));
+			auto& entry = entries.emplace_back(entry_info{.Locator = locatorAt(prev), .Allocation = locatorAt(curr).offset() - locatorAt(prev).offset()});
+			if (hasIndex1 && std::get<2>(offsets1[prev].second))
+				entry.PathSpec = compact_path_spec(path_spec(std::get<2>(offsets1[prev].second)), *PathArena);
+			else if (hasIndex2 && std::get<1>(offsets2[prev].second))
+				entry.PathSpec = compact_path_spec(path_spec(std::get<1>(offsets2[prev].second)), *PathArena);
 			else
-				Entries.back().PathSpec = path_spec(
-					std::get<0>(offsets1[prev].second),
-					std::get<1>(offsets1[prev].second),
-					std::get<0>(offsets2[prev].second),
+				entry.PathSpec = compact_path_spec(
+					hasIndex1 ? std::get<0>(offsets1[prev].second) : path_spec::EmptyHashValue,
+					hasIndex1 ? std::get<1>(offsets1[prev].second) : path_spec::EmptyHashValue,
+					hasIndex2 ? std::get<0>(offsets2[prev].second) : path_spec::EmptyHashValue,
 					CategoryId,
 					ExpacId,
 					PartId);
 		}
-	} else if (!offsets1.empty()) {
-		for (size_t curr = 1, prev = 0; curr < offsets1.size(); ++curr, ++prev) {
-
-			// Skip dummy items to mark end of individual .dat file.
-			if (offsets1[prev].first.DatFileIndex != offsets1[curr].first.DatFileIndex)
-				continue;
+		return entries;
+	};
 
-			Entries.emplace_back(entry_info{.Locator = offsets1[prev].first, .Allocation = offsets1[curr].first.offset() - offsets1[prev].first.offset()});
-			if (std::get<2>(offsets1[prev].second))
-				Entries.back().PathSpec = path_spec(std::get<2>(offsets1[prev].second));
-			else
-				Entries.back().PathSpec = path_spec(
-					std::get<0>(offsets1[prev].second),
-					std::get<1>(offsets1[prev].second),
-					path_spec::EmptyHashValue,
-					CategoryId,
-					ExpacId,
-					PartId);
+	if (offsetCount > 1) {
+		static constexpr size_t MinEntriesPerChunk = 8192;
+		auto& pool = util::thread_pool::pool::current();
+		const auto chunkCount = (std::max<size_t>)(1, (std::min<size_t>)(pool.concurrency(), (offsetCount - 1) / MinEntriesPerChunk));
+		std::vector<std::vector<entry_info>> chunks(chunkCount);
+		util::thread_pool::task_waiter<bool> waiter(pool);
+		for (size_t i = 0; i < chunkCount; ++i) {
+			waiter.submit([&buildEntries, &chunk = chunks[i], from = (offsetCount - 1) * i / chunkCount, to = (offsetCount - 1) * (i + 1) / chunkCount](util::thread_pool::base_task&) {
+				chunk = buildEntries(from, to);
+				return true;
+			});
 		}
-	} else if (!offsets2.empty()) {
-		for (size_t curr = 1, prev = 0; curr < offsets2.size(); ++curr, ++prev) {
+		waiter.wait_all();
+
+		size_t entryCount = 0;
+		for (const auto& chunk : chunks)
+			entryCount += chunk.size();
+		Entries.reserve(entryCount);
+		for (const auto& chunk : chunks)
+			Entries.insert(Entries.end(), chunk.begin(), chunk.end());
+	}
 
-			// Skip dummy items to mark end of individual .dat file.
-			if (offsets2[prev].first.DatFileIndex != offsets2[curr].first.DatFileIndex)
-				continue;
+	parallel_sort(Entries, Comparator());
 
-			Entries.emplace_back(entry_info{.Locator = offsets2[prev].first, .Allocation = offsets2[curr].first.offset() - offsets2[prev].first.offset()});
-			if (std::get<1>(offsets2[prev].second))
-				Entries.back().PathSpec = path_spec(std::get<1>(offsets2[prev].second));
-			else
-				Entries.back().PathSpec = path_spec(
-					path_spec::EmptyHashValue,
-					path_spec::EmptyHashValue,
-					std::get<0>(offsets2[prev].second),
-					CategoryId,
-					ExpacId,
-					PartId);
-		}
+	// Deduplicated entries share a locator, and only the last one of them got the allocation up to the next entry.
+	for (auto runBegin = Entries.begin(); runBegin != Entries.end();) {
+		auto runEnd = std::next(runBegin);
+		auto allocation = runBegin->Allocation;
+		for (; runEnd != Entries.end() && runEnd->Locator == runBegin->Locator; ++runEnd)
+			allocation = (std::max)(allocation, runEnd->Allocation);
+		for (; runBegin != runEnd; ++runBegin)
+			runBegin->Allocation = allocation;
 	}
 
-	std::sort(Entries.begin(), Entries.end(), Comparator());
+	verifier.wait_all();
 }
 
 xivres::sqpack::reader xivres::sqpack::reader::from_path(const std::filesystem::path& indexFile, bool strictVerify) {
 	static constexpr char emptyIndex[] = "\x53\x71\x50\x61\x63\x6b\x00\x00\x00\x00\x00\x00\x00\x04\x00\x00\x01\x00\x00\x00\x02\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\xff\xff\xff\xff\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x14\x03\x16\xfb\x3d\x2f\x7a\x61\xd8\xd9\x51\x20\x12\xe4\x4a\xf6\xa1\xe1\x45\x2e\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x04\x00\x00\x01\x00\x00\x00\x00\x08\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x01\x00\x00\x00\x00\x08\x00\x00\x00\x01\x00\x00\x5e\x9d\x28\xd0\x48\x5d\xa8\x38\xf6\x2d\x71\x3c\x3d\xb6\x96\x1a\x6e\x13\xd8\x3b\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x09\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x57\x7f\x4d\xc3\x47\x77\xce\x82\xb2\xe9\xfe\xd5\x36\xe9\xf8\xb1\x49\x2b\xd9\x30\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\xff\xff\xff\xff\xff\xff\xff\xff\x00\x00\x00\x00\xff\xff\xff\xff\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00";
 
 	std::vector<std::shared_ptr<stream>> dataStreams;
-	for (int i = 0; i < 8; ++i) {
+	for (size_t i = 0; i < MaxDataFileCount; ++i) {
 		auto dataPath = std::filesystem::path(indexFile);
 		dataPath.replace_extension(std::format(".dat{}", i));
 		if (!exists(dataPath))
@@ -288,7 +407,29 @@ const xivres::sqpack::sqindex::data_locator& xivres::sqpack::reader::data_locato
 	throw std::out_of_range("File does not exist");
 }
 
+const xivres::sqpack::sqindex::data_locator* xivres::sqpack::reader::find_data_locator_from_index1(const hashed_path& path) const {
+	const auto locator = Index1.find_data_locator(path.PathHash, path.NameHash);
+	if (locator && locator->IsSynonym)
+		return path.Text.empty() ? nullptr : Index1.find_data_locator(path_spec(path.Text).text().c_str());
+	return locator;
+}
+
+const xivres::sqpack::sqindex::data_locator* xivres::sqpack::reader::find_data_locator_from_index2(const hashed_path& path) const {
+	const auto locator = Index2.find_data_locator(path.FullPathHash);
+	if (locator && locator->IsSynonym)
+		return path.Text.empty() ? nullptr : Index2.find_data_locator(path_spec(path.Text).text().c_str());
+	return locator;
+}
+
 size_t xivres::sqpack::reader::find_entry_index(const path_spec& pathSpec) const {
+	return find_entry_index(find_data_locator_from_index1(pathSpec));
+}
+
+size_t xivres::sqpack::reader::find_entry_index(const hashed_path& path) const {
+	return find_entry_index(find_data_locator_from_index1(path));
+}
+
+size_t xivres::sqpack::reader::find_entry_index(const sqindex::data_locator* locator) const {
 	struct Comparator {
 		bool operator()(const entry_info& l, const sqindex::data_locator& r) const {
 			return l.Locator < r;
@@ -299,7 +440,6 @@ size_t xivres::sqpack::reader::find_entry_index(const path_spec& pathSpec) const
 		}
 	};
 
-	const auto locator = find_data_locator_from_index1(pathSpec);
 	if (!locator)
 		return (std::numeric_limits<size_t>::max)();
 
@@ -314,6 +454,13 @@ size_t xivres::sqpack::reader::get_entry_index(const path_spec& pathSpec) const
 	return res;
 }
 
+size_t xivres::sqpack::reader::get_entry_index(const hashed_path& path) const {
+	const auto res = find_entry_index(path);
+	if (res == (std::numeric_limits<size_t>::max)())
+		throw std::out_of_range("File does not exist");
+	return res;
+}
+
 std::shared_ptr<xivres::packed_stream> xivres::sqpack::reader::packed_at(const entry_info& info) const {
 	return std::make_unique<stream_as_packed_stream>(info.PathSpec, std::make_shared<partial_view_stream>(Data.at(info.Locator.DatFileIndex).Stream, info.Locator.offset(), info.Allocation));
 }
@@ -322,6 +469,10 @@ std::shared_ptr<xivres::packed_stream> xivres::sqpack::reader::packed_at(const p
 	return packed_at(Entries[get_entry_index(pathSpec)]);
 }
 
+std::shared_ptr<xivres::packed_stream> xivres::sqpack::reader::packed_at(const hashed_path& path) const {
+	return packed_at(Entries[get_entry_index(path)]);
+}
+
 std::shared_ptr<xivres::unpacked_stream> xivres::sqpack::reader::at(const entry_info& info, std::span<uint8_t> obfuscatedHeaderRewrite) const {
 	return std::make_shared<unpacked_stream>(packed_at(info), obfuscatedHeaderRewrite);
 }
@@ -329,3 +480,83 @@ std::shared_ptr<xivres::unpacked_stream> xivres::sqpack::reader::at(const entry_
 std::shared_ptr<xivres::unpacked_stream> xivres::sqpack::reader::at(const path_spec& pathSpec, std::span<uint8_t> obfuscatedHeaderRewrite) const {
 	return std::make_shared<unpacked_stream>(packed_at(pathSpec), obfuscatedHeaderRewrite);
 }
+
+std::shared_ptr<xivres::unpacked_stream> xivres::sqpack::reader::at(const hashed_path& path, std::span<uint8_t> obfuscatedHeaderRewrite) const {
+	return std::make_shared<unpacked_stream>(packed_at(path), obfuscatedHeaderRewrite);
+}
+
+xivres::sqpack::reader::metadata_table xivres::sqpack::reader::scan_metadata() const {
+	// Enough for the headers of nearly everything; larger headers get read again on their own.
+	static constexpr size_t HeaderProbeSize = 1024;
+	// Headers at most this far apart from each other are fetched in one read, along with whatever is between them.
+	static constexpr uint64_t MaxGapWithinRead = 16384;
+	static constexpr uint64_t MaxReadSize = 1048576;
+
+	metadata_table res;
+	res.Type.resize(Entries.size(), packed::type::invalid);
+	res.DecompressedSize.resize(Entries.size());
+	res.BlockCount.resize(Entries.size());
+	res.PackedSize.resize(Entries.size());
+
+	std::vector<std::vector<size_t>> rowsPerDat(Data.size());
+	for (size_t i = 0; i < Entries.size(); ++i) {
+		if (Entries[i].Locator.DatFileIndex < Data.size())
+			rowsPerDat[Entries[i].Locator.DatFileIndex].push_back(i);
+	}
+
+	util::thread_pool::task_waiter<size_t> waiter;
+	for (size_t datIndex = 0; datIndex < Data.size(); ++datIndex) {
+		if (rowsPerDat[datIndex].empty())
+			continue;
+
+		waiter.submit([this, &res, &rows = rowsPerDat[datIndex], &strm = *Data[datIndex].Stream](util::thread_pool::base_task& task) {
+			std::ranges::sort(rows, {}, [this](size_t row) { return Entries[row].Locator.offset(); });
+
+			const auto probeSize = [this](size_t row) {
+				return (std::min<uint64_t>)(HeaderProbeSize, Entries[row].Allocation);
+			};
+
+			std::vector<uint8_t> buf;
+			for (size_t first = 0, last; first < rows.size(); first = last) {
+				task.throw_if_cancelled();
+
+				const auto readFrom = Entries[rows[first]].Locator.offset();
+				auto readTo = readFrom + probeSize(rows[first]);
+				for (last = first + 1; last < rows.size(); ++last) {
+					const auto from = Entries[rows[last]].Locator.offset();
+					const auto to = from + probeSize(rows[last]);
+					if (from > readTo + MaxGapWithinRead || to - readFrom > MaxReadSize)
+						break;
+					readTo = (std::max)(readTo, to);
+				}
+
+				buf.resize(static_cast<size_t>(readTo - readFrom));
+				buf.resize(static_cast<size_t>(util::thread_pool::pool::current().release_working_status([&] {
+					return strm.read(static_cast<std::streamoff>(readFrom), buf.data(), static_cast<std::streamsize>(buf.size()));
+				})));
+
+				for (auto i = first; i < last; ++i) {
+					const auto& entry = Entries[rows[i]];
+					const auto offsetInBuf = static_cast<size_t>(entry.Locator.offset() - readFrom);
+					if (offsetInBuf + sizeof(packed::file_header) > buf.size())
+						continue;
+
+					const uint32_t headerSize = reinterpret_cast<const packed::file_header*>(&buf[offsetInBuf])->HeaderSize;
+					if (headerSize < sizeof(packed::file_header) || headerSize > entry.Allocation)
+						continue;
+
+					if (offsetInBuf + headerSize <= buf.size()) {
+						read_entry_metadata(std::span(buf).subspan(offsetInBuf, headerSize), res, rows[i]);
+					} else {
+						const auto head = strm.read_vector<uint8_t>(static_cast<std::streamoff>(entry.Locator.offset()), headerSize);
+						read_entry_metadata(head, res, rows[i]);
+					}
+				}
+			}
+			return rows.size();
+		});
+	}
+	waiter.wait_all();
+
+	return res;
+}
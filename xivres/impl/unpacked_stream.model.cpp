@@ -35,6 +35,12 @@ xivres::model_unpacker::model_unpacker(const packed::file_header& header, std::s
 			continue;
 
 		const size_t blockIndex = *locator.FirstBlockIndices.at(i);
+		if (blockIndex >= blockCount)
+			throw bad_data_error("Out of bounds index information detected");
+
+		m_groups[i].FirstBlockIndex = static_cast<uint32_t>(blockIndex);
+		m_groups[i].BlockCount = locator.BlockCount.at(i);
+
 		auto& firstBlock = m_blocks[blockIndex];
 		firstBlock.GroupIndex = i;
 		firstBlock.GroupBlockIndex = 0;
@@ -51,18 +57,30 @@ xivres::model_unpacker::model_unpacker(const packed::file_header& header, std::s
 		}
 	}
 
+	// Read every block in one go to take the block headers from; the data is read again only for the blocks a read decodes.
+	const auto packedFrom = static_cast<std::streamoff>(m_blocks.front().BlockOffset);
+	const auto packedTo = (std::min<std::streamoff>)(underlyingSize, m_blocks.back().BlockOffset + m_blocks.back().PaddedChunkSize);
+	if (packedTo < packedFrom)
+		throw bad_data_error("Blocks begin past the end of the file");
+	std::vector<uint8_t> packedBlocks(static_cast<size_t>(packedTo - packedFrom));
+	m_stream->read_fully(packedFrom, std::span(packedBlocks));
+
 	auto lastOffset = 0;
 	for (auto& block : m_blocks) {
 		packed::block_header blockHeader;
 
 		if (block.BlockOffset == underlyingSize)
 			blockHeader.DecompressedSize = blockHeader.CompressedSize = 0;
+		else if (block.BlockOffset - packedFrom + sizeof blockHeader > packedBlocks.size())
+			throw bad_data_error("Block header is past the end of the file");
 		else
-			m_stream->read_fully(block.BlockOffset, &blockHeader, sizeof blockHeader);
+			std::memcpy(&blockHeader, &packedBlocks[static_cast<size_t>(block.BlockOffset - packedFrom)], sizeof blockHeader);
 
 		block.DecompressedSize = static_cast<uint16_t>(blockHeader.DecompressedSize);
 		block.RequestOffsetPastHeader = lastOffset;
 		lastOffset += block.DecompressedSize;
+		if (block.GroupIndex != UINT16_MAX)
+			m_groups[block.GroupIndex].DecompressedSize += block.DecompressedSize;
 	}
 
 	for (size_t blkI = locator.FirstBlockIndices.Stack, i_ = blkI + locator.BlockCount.Stack; blkI < i_; ++blkI)
@@ -88,30 +106,101 @@ std::streamsize xivres::model_unpacker::read(std::streamoff offset, void* buf, s
 	if (info.complete() || m_blocks.empty())
 		return info.filled();
 
-	auto it = std::upper_bound(m_blocks.begin(), m_blocks.end(), info.current_offset());
+	const auto dataFrom = static_cast<uint32_t>((std::max<std::streamoff>)(offset, sizeof m_header) - sizeof m_header);
+	const auto dataTo = static_cast<uint32_t>((std::min<std::streamoff>)(offset + length, size()) - sizeof m_header);
+	if (dataFrom >= dataTo) {
+		info.skip_to(size());
+		return info.filled();
+	}
+
+	auto it = std::upper_bound(m_blocks.begin(), m_blocks.end(), dataFrom);
 	if (it != m_blocks.begin())
 		--it;
+	const auto itEnd = std::upper_bound(it, m_blocks.end(), dataTo - 1);
+
+	// Groups do not depend on each other; if the request spans more than one, decode each of them in its own task.
+	const auto sameGroupAs = [](const block_info_t& first) {
+		return [groupIndex = first.GroupIndex](const block_info_t& block) { return block.GroupIndex == groupIndex; };
+	};
+	const auto multipleGroups = !std::all_of(it, itEnd, sameGroupAs(*it));
+
+	// Bytes of the requested range that no block covers are zero-filled here, as the runs only write what they decode.
+	const auto zeroFill = [&](uint32_t from, uint32_t to) {
+		if (from < to)
+			std::fill_n(static_cast<uint8_t*>(buf) + (sizeof m_header + from - offset), to - from, 0);
+	};
+
+	util::thread_pool::task_waiter<size_t> waiter;
+	auto coveredTo = dataFrom;
+	for (auto runBegin = it; runBegin != itEnd;) {
+		const auto runEnd = std::find_if_not(runBegin, itEnd, sameGroupAs(*runBegin));
+		const auto runFrom = (std::max)(dataFrom, runBegin->RequestOffsetPastHeader);
+		const auto runTo = (std::min)(dataTo, std::prev(runEnd)->RequestOffsetPastHeader + std::prev(runEnd)->DecompressedSize);
+		if (runFrom < runTo) {
+			zeroFill(coveredTo, runFrom);
+			coveredTo = (std::max)(coveredTo, runTo);
+			const auto blocks = std::span(runBegin, runEnd);
+			const auto skip = runFrom - runBegin->RequestOffsetPastHeader;
+			const auto target = std::span(static_cast<uint8_t*>(buf) + (sizeof m_header + runFrom - offset), runTo - runFrom);
+			if (multipleGroups)
+				waiter.submit([this, blocks, skip, target](util::thread_pool::base_task&) { return decode_blocks(blocks, skip, target); });
+			else
+				decode_blocks(blocks, skip, target);
+		}
+		runBegin = runEnd;
+	}
+	zeroFill(coveredTo, dataTo);
+	waiter.wait_all();
 
-	const auto itEnd = std::upper_bound(it, m_blocks.end(), static_cast<uint32_t>(offset + length));
-	info.multithreaded(std::distance(it, itEnd) >= MinBlockCountForMultithreadedDecompression);
+	info.skip_to(sizeof m_header + dataTo, true);
+	info.skip_to(size());
+	return info.filled();
+}
 
-	const auto preloadFrom = static_cast<std::streamoff>(it->BlockOffset);
-	const auto preloadTo = static_cast<std::streamoff>(itEnd == m_blocks.end() ? m_blocks.back().BlockOffset + m_blocks.back().PaddedChunkSize: itEnd->BlockOffset);
+xivres::model_unpacker::lod_buffers xivres::model_unpacker::read_lod(size_t lodIndex) {
+	if (lodIndex >= 3)
+		throw std::out_of_range(std::format("LOD {} does not exist", lodIndex));
 
-	auto pooledPreload = *m_preloads;
-	if (!pooledPreload)
-		pooledPreload.emplace();
-	auto& preload = *pooledPreload;
-	preload.resize(preloadTo - preloadFrom);
-	util::thread_pool::pool::current().release_working_status([&] { m_stream->read_fully(preloadFrom, std::span(preload)); });
+	lod_buffers res;
+	std::vector<uint8_t>* const targets[3]{&res.Vertex, &res.EdgeGeometryVertex, &res.Index};
 
-	for (; it != m_blocks.end(); ++it) {
-		if (info.skip_to(it->RequestOffsetPastHeader + sizeof m_header))
-			break;
-		if (info.forward_sqblock(std::span(preload).subspan(it->BlockOffset - preloadFrom, it->PaddedChunkSize)))
+	util::thread_pool::task_waiter<size_t> waiter;
+	for (size_t i = 0; i < 3; ++i) {
+		const auto& group = m_groups[2 + lodIndex * 3 + i];
+		if (!group.BlockCount)
+			continue;
+
+		auto& target = *targets[i];
+		target.resize(group.DecompressedSize);
+		waiter.submit([this, &group, &target](util::thread_pool::base_task&) {
+			return decode_blocks(std::span(m_blocks).subspan(group.FirstBlockIndex, group.BlockCount), 0, std::span(target));
+		});
+	}
+	waiter.wait_all();
+
+	return res;
+}
+
+size_t xivres::model_unpacker::decode_blocks(std::span<const block_info_t> blocks, size_t skip, std::span<uint8_t> target) {
+	block_decoder info(*this, target.data(), static_cast<std::streamsize>(target.size()), static_cast<std::streamoff>(skip));
+	info.multithreaded(blocks.size() >= MinBlockCountForMultithreadedDecompression);
+
+	// Read only the packed bytes of the given blocks, which are contiguous, and let them go once decoded.
+	const auto packedFrom = static_cast<std::streamoff>(blocks.front().BlockOffset);
+	const auto packedTo = (std::min<std::streamoff>)(m_stream->size(), blocks.back().BlockOffset + blocks.back().PaddedChunkSize);
+	std::vector<uint8_t> packedBlocks(static_cast<size_t>((std::max)(packedFrom, packedTo) - packedFrom));
+	m_stream->read_fully(packedFrom, std::span(packedBlocks));
+
+	for (const auto& block : blocks) {
+		if (!block.DecompressedSize)
+			continue;
+
+		const auto blockOffset = static_cast<size_t>(block.BlockOffset - packedFrom);
+		if (info.forward_sqblock(std::span(packedBlocks).subspan(blockOffset, (std::min<size_t>)(block.PaddedChunkSize, packedBlocks.size() - blockOffset))))
 			break;
 	}
-	
-	info.skip_to(size());
-	return info.filled();
+
+	// Zero-fill whatever the blocks did not cover.
+	info.skip_to(skip + target.size());
+	return static_cast<size_t>(info.filled());
 }
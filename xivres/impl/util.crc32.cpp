@@ -0,0 +1,215 @@
+#include "../include/xivres/util.crc32.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#include <cpuid.h>
+#define XIVRES_CRC32_TARGET_PCLMUL __attribute__((target("pclmul,sse4.1")))
+#else
+#include <intrin.h>
+#define XIVRES_CRC32_TARGET_PCLMUL
+#endif
+#endif
+
+namespace {
+	constexpr auto SlicedTables = [] {
+		std::array<std::array<uint32_t, 256>, 8> tables{};
+		tables[0] = xivres::util::crc32_internal::Table;
+		for (size_t k = 1; k < tables.size(); ++k) {
+			for (size_t i = 0; i < 256; ++i)
+				tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xFF];
+		}
+		return tables;
+	}();
+
+	uint32_t load_u32(const char* p) {
+		uint32_t v;
+		std::memcpy(&v, p, sizeof v);
+		return v;
+	}
+
+	// Operates on the raw (not inverted) register, slicing by 8 bytes at once.
+	uint32_t update_raw_scalar(uint32_t crc, const char* data, size_t length) {
+		const auto& t = SlicedTables;
+		for (; length >= 8; data += 8, length -= 8) {
+			const auto lo = crc ^ load_u32(data);
+			const auto hi = load_u32(data + 4);
+			crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24]
+				^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+		}
+		for (; length; ++data, --length)
+			crc = t[0][(crc ^ static_cast<uint8_t>(*data)) & 0xFF] ^ (crc >> 8);
+		return crc;
+	}
+
+#if defined(_M_X64) || defined(__x86_64__)
+	bool has_pclmul() {
+#if defined(__GNUC__) || defined(__clang__)
+		unsigned int eax, ebx, ecx, edx;
+		if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+			return false;
+		return (ecx & (1 << 1)) && (ecx & (1 << 19));
+#else
+		int regs[4];
+		__cpuid(regs, 1);
+		return (regs[2] & (1 << 1)) && (regs[2] & (1 << 19));
+#endif
+	}
+
+	XIVRES_CRC32_TARGET_PCLMUL __m128i fold(__m128i x, __m128i k, __m128i next) {
+		const auto lo = _mm_clmulepi64_si128(x, k, 0x00);
+		const auto hi = _mm_clmulepi64_si128(x, k, 0x11);
+		return _mm_xor_si128(_mm_xor_si128(hi, lo), next);
+	}
+
+	// Folds 64 bytes at a time with carry-less multiplication, then Barrett-reduces to 32 bits.
+	// Requires length >= 64 and a multiple of 16. See Intel's "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ".
+	XIVRES_CRC32_TARGET_PCLMUL uint32_t update_raw_pclmul(uint32_t crc, const char* data, size_t length) {
+		alignas(16) static constexpr uint64_t K1K2[] = {0x0154442bd4, 0x01c6e41596};
+		alignas(16) static constexpr uint64_t K3K4[] = {0x01751997d0, 0x00ccaa009e};
+		alignas(16) static constexpr uint64_t K5K0[] = {0x0163cd6124, 0x0000000000};
+		alignas(16) static constexpr uint64_t Poly[] = {0x01db710641, 0x01f7011641};
+
+		const auto load = [](const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); };
+
+		auto x1 = _mm_xor_si128(load(data), _mm_cvtsi32_si128(static_cast<int>(crc)));
+		auto x2 = load(data + 16);
+		auto x3 = load(data + 32);
+		auto x4 = load(data + 48);
+		data += 64;
+		length -= 64;
+
+		auto k = _mm_load_si128(reinterpret_cast<const __m128i*>(K1K2));
+		for (; length >= 64; data += 64, length -= 64) {
+			x1 = fold(x1, k, load(data));
+			x2 = fold(x2, k, load(data + 16));
+			x3 = fold(x3, k, load(data + 32));
+			x4 = fold(x4, k, load(data + 48));
+		}
+
+		k = _mm_load_si128(reinterpret_cast<const __m128i*>(K3K4));
+		x1 = fold(x1, k, x2);
+		x1 = fold(x1, k, x3);
+		x1 = fold(x1, k, x4);
+		for (; length >= 16; data += 16, length -= 16)
+			x1 = fold(x1, k, load(data));
+
+		// 128 bits to 64 bits.
+		const auto mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+		x2 = _mm_clmulepi64_si128(x1, k, 0x10);
+		x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+		k = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(K5K0));
+		x2 = _mm_srli_si128(x1, 4);
+		x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x00), x2);
+
+		// Barrett reduction to 32 bits.
+		k = _mm_load_si128(reinterpret_cast<const __m128i*>(Poly));
+		x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x10);
+		x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask32), k, 0x00);
+		x1 = _mm_xor_si128(x1, x2);
+		return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+	}
+
+	// Lowercases ASCII letters and turns backslashes into slashes, 16 bytes at a time.
+	// Returns false if any byte is not ASCII.
+	bool fold_path_chars(char* dst, const char* src, size_t length) {
+		auto nonAscii = _mm_setzero_si128();
+		const auto below = _mm_set1_epi8('A' - 1);
+		const auto above = _mm_set1_epi8('Z' + 1);
+		const auto caseBit = _mm_set1_epi8(0x20);
+		const auto backslash = _mm_set1_epi8('\\');
+		const auto slash = _mm_set1_epi8('/');
+		for (; length >= 16; src += 16, dst += 16, length -= 16) {
+			auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+			nonAscii = _mm_or_si128(nonAscii, v);
+			const auto upper = _mm_and_si128(_mm_cmpgt_epi8(v, below), _mm_cmplt_epi8(v, above));
+			v = _mm_or_si128(v, _mm_and_si128(upper, caseBit));
+			const auto isBackslash = _mm_cmpeq_epi8(v, backslash);
+			v = _mm_or_si128(_mm_andnot_si128(isBackslash, v), _mm_and_si128(isBackslash, slash));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v);
+		}
+		auto ascii = !_mm_movemask_epi8(nonAscii);
+		for (; length; ++src, ++dst, --length) {
+			ascii &= static_cast<uint8_t>(*src) < 0x80;
+			*dst = 'A' <= *src && *src <= 'Z' ? static_cast<char>(*src - 'A' + 'a') : *src == '\\' ? '/' : *src;
+		}
+		return ascii;
+	}
+#else
+	bool fold_path_chars(char* dst, const char* src, size_t length) {
+		auto ascii = true;
+		for (; length; ++src, ++dst, --length) {
+			ascii &= static_cast<uint8_t>(*src) < 0x80;
+			*dst = 'A' <= *src && *src <= 'Z' ? static_cast<char>(*src - 'A' + 'a') : *src == '\\' ? '/' : *src;
+		}
+		return ascii;
+	}
+#endif
+
+	uint32_t update_raw(uint32_t crc, const char* data, size_t length) {
+#if defined(_M_X64) || defined(__x86_64__)
+		static const auto s_hasPclmul = has_pclmul();
+		if (s_hasPclmul && length >= 64) {
+			const auto folded = length & ~static_cast<size_t>(15);
+			crc = update_raw_pclmul(crc, data, folded);
+			data += folded;
+			length -= folded;
+		}
+#endif
+		return update_raw_scalar(crc, data, length);
+	}
+}
+
+uint32_t xivres::util::crc32_update_fast(uint32_t crc, std::span<const char> data) {
+	return ~update_raw(~crc, data.data(), data.size());
+}
+
+void xivres::util::crc32_hash_paths(std::span<const std::string_view> paths, std::span<uint32_t> pathHashes, std::span<uint32_t> nameHashes, std::span<uint32_t> fullPathHashes) {
+	if (pathHashes.size() < paths.size() || nameHashes.size() < paths.size() || fullPathHashes.size() < paths.size())
+		throw std::invalid_argument("output spans are shorter than paths");
+
+	std::string buffer;
+	for (size_t i = 0; i < paths.size(); ++i) {
+		const auto& path = paths[i];
+		if (buffer.size() < path.size())
+			buffer.resize(path.size());
+		if (!fold_path_chars(buffer.data(), path.data(), path.size()))
+			throw std::invalid_argument("crc32_hash_paths only supports ASCII paths; use path_spec instead");
+
+		// Parts are separated by one or more slashes; leading and trailing slashes are ignored.
+		size_t firstOffset = std::string::npos, lastOffset = 0, lastEnd = 0;
+		for (size_t offset = 0; offset < path.size();) {
+			const auto next = static_cast<size_t>(std::find(buffer.data() + offset, buffer.data() + path.size(), '/') - buffer.data());
+			if (next != offset) {
+				if (firstOffset == std::string::npos)
+					firstOffset = offset;
+				lastOffset = offset;
+				lastEnd = next;
+			}
+			offset = next + 1;
+		}
+
+		if (firstOffset == std::string::npos) {
+			pathHashes[i] = nameHashes[i] = fullPathHashes[i] = 0xFFFFFFFFU;
+			continue;
+		}
+
+		nameHashes[i] = update_raw(0xFFFFFFFFU, buffer.data() + lastOffset, lastEnd - lastOffset);
+		if (firstOffset == lastOffset) {
+			pathHashes[i] = 0xFFFFFFFFU;
+			fullPathHashes[i] = nameHashes[i];
+		} else {
+			// The separator right before the name is a single slash after folding, so the full path is contiguous in buffer.
+			const auto pathCrc = update_raw(0xFFFFFFFFU, buffer.data() + firstOffset, lastOffset - 1 - firstOffset);
+			pathHashes[i] = pathCrc;
+			fullPathHashes[i] = update_raw(pathCrc, buffer.data() + lastOffset - 1, lastEnd - lastOffset + 1);
+		}
+	}
+}
@@ -0,0 +1,150 @@
+#include "../include/xivres/util.sha1.h"
+
+#include <utility>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#include <cpuid.h>
+#define XIVRES_SHA1_TARGET_SHANI __attribute__((target("sha,ssse3,sse4.1")))
+#else
+#include <intrin.h>
+#define XIVRES_SHA1_TARGET_SHANI
+#endif
+#endif
+
+namespace {
+	uint32_t left_rotate(uint32_t value, size_t count) {
+		return (value << count) ^ (value >> (32 - count));
+	}
+
+	void process_blocks_scalar(uint32_t* state, const uint8_t* data, size_t blockCount) {
+		for (; blockCount; --blockCount, data += 64) {
+			uint32_t w[80];
+			for (size_t i = 0; i < 16; i++) {
+				w[i] = (data[i * 4 + 0] << 24);
+				w[i] |= (data[i * 4 + 1] << 16);
+				w[i] |= (data[i * 4 + 2] << 8);
+				w[i] |= (data[i * 4 + 3]);
+			}
+			for (size_t i = 16; i < 80; i++) {
+				w[i] = left_rotate((w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16]), 1);
+			}
+
+			uint32_t a = state[0];
+			uint32_t b = state[1];
+			uint32_t c = state[2];
+			uint32_t d = state[3];
+			uint32_t e = state[4];
+
+			for (std::size_t i = 0; i < 80; ++i) {
+				uint32_t f;
+				uint32_t k;
+
+				if (i < 20) {
+					f = (b & c) | (~b & d);
+					k = 0x5A827999;
+				} else if (i < 40) {
+					f = b ^ c ^ d;
+					k = 0x6ED9EBA1;
+				} else if (i < 60) {
+					f = (b & c) | (b & d) | (c & d);
+					k = 0x8F1BBCDC;
+				} else {
+					f = b ^ c ^ d;
+					k = 0xCA62C1D6;
+				}
+				uint32_t temp = left_rotate(a, 5) + f + e + k + w[i];
+				e = d;
+				d = c;
+				c = left_rotate(b, 30);
+				b = a;
+				a = temp;
+			}
+
+			state[0] += a;
+			state[1] += b;
+			state[2] += c;
+			state[3] += d;
+			state[4] += e;
+		}
+	}
+
+#if defined(_M_X64) || defined(__x86_64__)
+	bool has_sha_extensions() {
+#if defined(__GNUC__) || defined(__clang__)
+		unsigned int eax, ebx, ecx, edx;
+		if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+			return false;
+		const auto hasSse41 = (ecx & (1 << 19)) && (ecx & (1 << 9));
+		if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+			return false;
+		return hasSse41 && (ebx & (1 << 29));
+#else
+		int regs[4];
+		__cpuid(regs, 0);
+		if (regs[0] < 7)
+			return false;
+		__cpuid(regs, 1);
+		const auto hasSse41 = (regs[2] & (1 << 19)) && (regs[2] & (1 << 9));
+		__cpuidex(regs, 7, 0);
+		return hasSse41 && (regs[1] & (1 << 29));
+#endif
+	}
+
+	// Four rounds; msgs[I % 4] holds message words 4I..4I+3 once this returns.
+	template<size_t I>
+	XIVRES_SHA1_TARGET_SHANI void sha_ni_rounds(__m128i& abcd, __m128i& e, __m128i& abcdPrev, __m128i(&msgs)[4], const uint8_t* data, __m128i byteSwapMask) {
+		__m128i msg;
+		if constexpr (I < 4) {
+			msg = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * I)), byteSwapMask);
+		} else {
+			msg = _mm_sha1msg1_epu32(msgs[I % 4], msgs[(I + 1) % 4]);
+			msg = _mm_xor_si128(msg, msgs[(I + 2) % 4]);
+			msg = _mm_sha1msg2_epu32(msg, msgs[(I + 3) % 4]);
+		}
+		msgs[I % 4] = msg;
+
+		const auto e2 = I == 0 ? _mm_add_epi32(e, msg) : _mm_sha1nexte_epu32(abcdPrev, msg);
+		abcdPrev = abcd;
+		abcd = _mm_sha1rnds4_epu32(abcd, e2, I / 5);
+	}
+
+	template<size_t... Is>
+	XIVRES_SHA1_TARGET_SHANI void sha_ni_block(__m128i& abcd, __m128i& e, __m128i& abcdPrev, const uint8_t* data, __m128i byteSwapMask, std::index_sequence<Is...>) {
+		__m128i msgs[4];
+		(sha_ni_rounds<Is>(abcd, e, abcdPrev, msgs, data, byteSwapMask), ...);
+	}
+
+	XIVRES_SHA1_TARGET_SHANI void process_blocks_sha_ni(uint32_t* state, const uint8_t* data, size_t blockCount) {
+		const auto byteSwapMask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+		auto abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1B);
+		auto e = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+
+		for (; blockCount; --blockCount, data += 64) {
+			const auto abcdSaved = abcd;
+			const auto eSaved = e;
+
+			__m128i abcdPrev = abcd;
+			sha_ni_block(abcd, e, abcdPrev, data, byteSwapMask, std::make_index_sequence<20>());
+
+			e = _mm_sha1nexte_epu32(abcdPrev, eSaved);
+			abcd = _mm_add_epi32(abcd, abcdSaved);
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1B));
+		state[4] = static_cast<uint32_t>(_mm_extract_epi32(e, 3));
+	}
+#endif
+}
+
+void xivres::util::hash_sha1::process_blocks(digest32_t state, const uint8_t* data, size_t blockCount) {
+#if defined(_M_X64) || defined(__x86_64__)
+	static const auto s_hasShaExtensions = has_sha_extensions();
+	if (s_hasShaExtensions)
+		return process_blocks_sha_ni(state, data, blockCount);
+#endif
+	process_blocks_scalar(state, data, blockCount);
+}
@@ -1,21 +1,160 @@
 #include "../include/xivres/util.thread_pool.h"
 
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <format>
+#include <ostream>
+
+namespace {
+	/// \brief Per-worker queue of raw task pointers, handed out in invoke path order like the injection queue.
+	/// The owning worker pushes to and takes from it; other workers steal from it under the same lock, which is only
+	/// contended while a thief is looking at this worker.
+	class work_queue {
+		using base_task = xivres::util::thread_pool::base_task;
+
+		static bool lower_priority(const base_task* l, const base_task* r) {
+			return *l < *r;
+		}
+
+		std::mutex m_mtx;
+		std::vector<base_task*> m_heap;
+		std::atomic_size_t m_size{ 0 };
+
+	public:
+		work_queue() = default;
+		work_queue(work_queue&&) = delete;
+		work_queue(const work_queue&) = delete;
+		work_queue& operator=(work_queue&&) = delete;
+		work_queue& operator=(const work_queue&) = delete;
+		~work_queue() = default;
+
+		[[nodiscard]] bool empty() const {
+			return m_size.load(std::memory_order_seq_cst) == 0;
+		}
+
+		[[nodiscard]] size_t size() const {
+			return m_size.load(std::memory_order_relaxed);
+		}
+
+		void push(base_task* pTask) {
+			std::lock_guard lock(m_mtx);
+			m_heap.push_back(pTask);
+			std::ranges::push_heap(m_heap, &lower_priority);
+			m_size.store(m_heap.size(), std::memory_order_seq_cst);
+		}
+
+		/// \brief Takes the task with the lowest invoke path, or returns nullptr if there is none.
+		[[nodiscard]] base_task* pop() {
+			if (empty())
+				return nullptr;
+
+			std::lock_guard lock(m_mtx);
+			if (m_heap.empty())
+				return nullptr;
+
+			std::ranges::pop_heap(m_heap, &lower_priority);
+			const auto pTask = m_heap.back();
+			m_heap.pop_back();
+			m_size.store(m_heap.size(), std::memory_order_seq_cst);
+			return pTask;
+		}
+	};
+
+	/// \brief Latency histogram that is written by its owning worker and may be read from any thread.
+	class atomic_latency_histogram {
+		using latency_histogram = xivres::util::thread_pool::latency_histogram;
+
+		std::atomic_uint64_t m_buckets[latency_histogram::BucketCount]{};
+		std::atomic_uint64_t m_count{};
+		std::atomic_int64_t m_totalNs{};
+		std::atomic_int64_t m_maxNs{};
+
+	public:
+		void add(std::chrono::nanoseconds duration) {
+			m_buckets[latency_histogram::bucket_index(duration)].fetch_add(1, std::memory_order_relaxed);
+			m_count.fetch_add(1, std::memory_order_relaxed);
+			m_totalNs.fetch_add(duration.count(), std::memory_order_relaxed);
+			if (duration.count() > m_maxNs.load(std::memory_order_relaxed))
+				m_maxNs.store(duration.count(), std::memory_order_relaxed);
+		}
+
+		void accumulate_to(latency_histogram& target) const {
+			for (size_t i = 0; i < latency_histogram::BucketCount; i++)
+				target.Buckets[i] += m_buckets[i].load(std::memory_order_relaxed);
+			target.Count += m_count.load(std::memory_order_relaxed);
+			target.Total += std::chrono::nanoseconds(m_totalNs.load(std::memory_order_relaxed));
+			target.Max = (std::max)(target.Max, std::chrono::nanoseconds(m_maxNs.load(std::memory_order_relaxed)));
+		}
+	};
+
+	struct trace_record {
+		xivres::util::thread_pool::invoke_path_type InvokePath;
+		std::chrono::steady_clock::time_point SubmittedAt;
+		std::chrono::steady_clock::time_point StartedAt;
+		std::chrono::steady_clock::time_point FinishedAt;
+	};
+
+	double to_trace_timestamp(std::chrono::steady_clock::duration duration) {
+		return std::chrono::duration<double, std::micro>(duration).count();
+	}
+}
+
+struct xivres::util::thread_pool::pool::worker {
+	pool& Owner;
+	worker* Next = nullptr;
+	const size_t Index;
+
+	std::thread Thread;
+	bool Occupied = false;  // guarded by pool::m_pmtxThread
+
+	base_task* Task = nullptr;  // accessed only from the worker thread
+	work_queue Queue;
+
+	std::atomic_uint64_t CompletedTasks{};
+	std::atomic_uint64_t StolenTasks{};
+	atomic_latency_histogram WaitLatency;
+	atomic_latency_histogram RunLatency;
+
+	std::mutex TraceMtx;
+	std::vector<trace_record> Trace;
+
+	worker(pool& owner, size_t index) : Owner(owner), Index(index) {}
+};
+
+thread_local xivres::util::thread_pool::pool::worker* xivres::util::thread_pool::pool::s_pCurrentWorker = nullptr;
+
 xivres::util::thread_pool::pool::pool(size_t nConcurrentExecutions)
-	: m_pmtxThread(std::make_shared<std::shared_mutex>())
+	: m_pWorkers(nullptr)
+	, m_pmtxThread(std::make_shared<std::mutex>())
+	, m_nThreads(0)
 	, m_nConcurrency(nConcurrentExecutions == (std::numeric_limits<size_t>::max)() ? std::thread::hardware_concurrency() : (std::max<size_t>)(1, nConcurrentExecutions))
-	, m_nWaitingThreads(0)
-	, m_nFreeThreads(0)
+	, m_nActiveThreads(0)
+	, m_nIdleThreads(0)
+	, m_nSleepingThreads(0)
 	, m_bQuitting(false)
-	, m_pmtxTask(std::make_shared<std::mutex>()) {
+	, m_nTaskCounter(0)
+	, m_nInjectedTasks(0)
+	, m_nWorkerSlots(0)
+	, m_nSpawnedThreads(0)
+	, m_nRetiredThreads(0)
+	, m_bTracing(false) {
 }
 
 xivres::util::thread_pool::pool::~pool() {
 	m_bQuitting = true;
-	m_cvTask.notify_one();
+	wake_all_workers();
+
+	{
+		std::unique_lock lock(*m_pmtxThread);
+		m_cvThread.wait(lock, [this] { return m_nThreads == 0; });
+	}
 
-	std::unique_lock lock(*m_pmtxThread);
-	while (!m_mapThreads.empty())
-		m_cvThread.wait(lock);
+	for (auto pWorker = m_pWorkers.load(); pWorker;) {
+		const auto pNext = pWorker->Next;
+		delete pWorker;
+		pWorker = pNext;
+	}
 }
 
 xivres::util::thread_pool::pool& xivres::util::thread_pool::pool::instance() {
@@ -24,99 +163,365 @@ xivres::util::thread_pool::pool& xivres::util::thread_pool::pool::instance() {
 }
 
 xivres::util::thread_pool::pool& xivres::util::thread_pool::pool::current() {
+	if (s_pCurrentWorker)
+		return s_pCurrentWorker->Owner;
 	return instance();
 }
 
 void xivres::util::thread_pool::pool::throw_if_current_task_cancelled() {
-	if (const auto pTask = instance().current_task())
-		pTask->throw_if_cancelled(); 
+	if (const auto pTask = current().current_task())
+		pTask->throw_if_cancelled();
 }
 
 xivres::util::thread_pool::base_task* xivres::util::thread_pool::pool::current_task() const {
-	std::shared_lock lock(*m_pmtxThread);
-	if (const auto it = m_mapThreads.find(std::this_thread::get_id()); it != m_mapThreads.end())
-		return it->second.Task.get();
+	if (s_pCurrentWorker && &s_pCurrentWorker->Owner == this)
+		return s_pCurrentWorker->Task;
 	return nullptr;
 }
 
 void xivres::util::thread_pool::pool::concurrency(size_t newConcurrency) {
-	std::lock_guard lock(*m_pmtxTask);
 	m_nConcurrency = newConcurrency;
-	m_cvTask.notify_one();
+	dispatch_task_to_worker();
 }
 
 size_t xivres::util::thread_pool::pool::concurrency() const {
 	return m_nConcurrency;
 }
 
+xivres::util::thread_pool::pool::statistics xivres::util::thread_pool::pool::get_statistics() const {
+	statistics res;
+	res.Concurrency = m_nConcurrency;
+	res.ActiveThreads = m_nActiveThreads;
+	res.IdleThreads = m_nIdleThreads;
+	res.QueuedTasks = m_nInjectedTasks;
+	res.SubmittedTasks = m_nTaskCounter;
+
+	{
+		std::lock_guard lock(*m_pmtxThread);
+		res.Threads = m_nThreads;
+		res.SpawnedThreads = m_nSpawnedThreads;
+		res.RetiredThreads = m_nRetiredThreads;
+	}
+
+	for (auto pWorker = m_pWorkers.load(std::memory_order_acquire); pWorker; pWorker = pWorker->Next) {
+		res.QueuedTasks += pWorker->Queue.size();
+		res.CompletedTasks += pWorker->CompletedTasks.load(std::memory_order_relaxed);
+		res.StolenTasks += pWorker->StolenTasks.load(std::memory_order_relaxed);
+		pWorker->WaitLatency.accumulate_to(res.WaitLatency);
+		pWorker->RunLatency.accumulate_to(res.RunLatency);
+	}
+
+	return res;
+}
+
+void xivres::util::thread_pool::pool::begin_trace() {
+	for (auto pWorker = m_pWorkers.load(std::memory_order_acquire); pWorker; pWorker = pWorker->Next) {
+		std::lock_guard lock(pWorker->TraceMtx);
+		pWorker->Trace.clear();
+	}
+
+	m_traceStartedAt.store(std::chrono::steady_clock::now(), std::memory_order_relaxed);
+	m_bTracing.store(true, std::memory_order_release);
+}
+
+void xivres::util::thread_pool::pool::end_trace(std::ostream& os) {
+	m_bTracing = false;
+	const auto traceStartedAt = m_traceStartedAt.load(std::memory_order_relaxed);
+
+	os << R"({"displayTimeUnit":"ns","traceEvents":[)";
+	auto first = true;
+	for (auto pWorker = m_pWorkers.load(std::memory_order_acquire); pWorker; pWorker = pWorker->Next) {
+		std::vector<trace_record> records;
+		{
+			std::lock_guard lock(pWorker->TraceMtx);
+			records = std::move(pWorker->Trace);
+			pWorker->Trace.clear();
+		}
+		if (records.empty())
+			continue;
+
+		os << (first ? "" : ",") << std::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{0},"args":{{"name":"Worker {0}"}}}})", pWorker->Index);
+		first = false;
+
+		for (const auto& record : records) {
+			std::string path;
+			for (size_t i = 0; i < record.InvokePath.Depth; i++)
+				path += std::format("{}{}", i ? "/" : "", record.InvokePath.Stack[i]);
+
+			os << std::format(
+				R"(,{{"name":"task {}","cat":"task","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f},"args":{{"invoke_path":"{}","depth":{},"wait_us":{:.3f}}}}})",
+				path,
+				pWorker->Index,
+				to_trace_timestamp(record.StartedAt - traceStartedAt),
+				to_trace_timestamp(record.FinishedAt - record.StartedAt),
+				path,
+				record.InvokePath.Depth,
+				to_trace_timestamp(record.StartedAt - record.SubmittedAt));
+		}
+	}
+	os << "]}";
+}
+
+size_t xivres::util::thread_pool::latency_histogram::bucket_index(std::chrono::nanoseconds duration) {
+	if (duration.count() <= 0)
+		return 0;
+	return (std::min<size_t>)(BucketCount - 1, std::bit_width(static_cast<uint64_t>(duration.count())));
+}
+
+void xivres::util::thread_pool::latency_histogram::add(std::chrono::nanoseconds duration) {
+	Buckets[bucket_index(duration)]++;
+	Count++;
+	Total += duration;
+	Max = (std::max)(Max, duration);
+}
+
+xivres::util::thread_pool::latency_histogram& xivres::util::thread_pool::latency_histogram::operator+=(const latency_histogram& r) {
+	for (size_t i = 0; i < BucketCount; i++)
+		Buckets[i] += r.Buckets[i];
+	Count += r.Count;
+	Total += r.Total;
+	Max = (std::max)(Max, r.Max);
+	return *this;
+}
+
+std::chrono::nanoseconds xivres::util::thread_pool::latency_histogram::mean() const {
+	return Count ? Total / static_cast<int64_t>(Count) : std::chrono::nanoseconds::zero();
+}
+
+std::chrono::nanoseconds xivres::util::thread_pool::latency_histogram::percentile(double percentile) const {
+	if (!Count)
+		return std::chrono::nanoseconds::zero();
+
+	const auto target = static_cast<uint64_t>(std::ceil(static_cast<double>(Count) * (std::clamp)(percentile, 0., 100.) / 100.));
+	uint64_t seen = 0;
+	for (size_t i = 0; i < BucketCount - 1; i++) {
+		seen += Buckets[i];
+		if (seen >= target && seen)
+			return (std::min)(Max, std::chrono::nanoseconds(int64_t{ 1 } << i));
+	}
+	return Max;
+}
+
 bool xivres::util::thread_pool::base_task::operator<(const base_task& r) const {
 	return m_invokePath > r.m_invokePath;
 }
 
 xivres::util::on_dtor xivres::util::thread_pool::pool::release_working_status() {
-	std::lock_guard lock(*m_pmtxTask);
-	if (!m_mapThreads.contains(std::this_thread::get_id()))
+	if (!current_task())
 		return {};
 
-	m_nWaitingThreads += 1;
+	m_nActiveThreads -= 1;
 	dispatch_task_to_worker();
-	return { [this] { m_nWaitingThreads -= 1; } };
+	return { [this] { m_nActiveThreads += 1; } };
 }
 
-void xivres::util::thread_pool::pool::worker_body() {
-	std::shared_ptr pmtxTask(m_pmtxTask);
-	std::shared_ptr pmtxThread(m_pmtxThread);
-	std::unique_lock taskLock(*pmtxTask);
-	std::unique_lock threadLock(*pmtxThread);
+void xivres::util::thread_pool::pool::enqueue(std::shared_ptr<base_task> pTask) {
+	pTask->m_submittedAt = std::chrono::steady_clock::now();
+
+	invoke_path_type& invokePath = pTask->m_invokePath;
+	if (const auto pCurrentTask = current_task())
+		invokePath = pCurrentTask->m_invokePath;
+	invokePath.Stack[(std::min<size_t>)(invokePath.Depth, invoke_path_type::StackSize - 1)] = static_cast<uint16_t>(m_nTaskCounter++);
+	if (invokePath.Depth < invoke_path_type::StackSize)
+		++invokePath.Depth;
+
+	if (s_pCurrentWorker && &s_pCurrentWorker->Owner == this) {
+		const auto pRawTask = pTask.get();
+		pRawTask->m_pQueuedSelf = std::move(pTask);
+		s_pCurrentWorker->Queue.push(pRawTask);
+	} else {
+		std::lock_guard lock(m_mtxTask);
+		m_pqTasks.emplace(std::move(pTask));
+		m_nInjectedTasks = m_pqTasks.size();
+	}
+
+	dispatch_task_to_worker();
+}
 
-	const auto it = m_mapThreads.find(std::this_thread::get_id());
-	threadLock.unlock();
+void xivres::util::thread_pool::pool::worker_body(worker& self) {
+	const auto pmtxThread = m_pmtxThread;
+	s_pCurrentWorker = &self;
 
-	auto& [thread, pTask] = it->second;
+	// m_nIdleThreads has been incremented for this thread by spawn_worker.
 	while (true) {
-		if (!take_task(pTask)) {
-			const auto waitFrom = std::chrono::steady_clock::now();
-			m_nFreeThreads++;
-			++m_nWaitingThreads;
-			while (!take_task(pTask)) {
-				if (m_bQuitting)
-					break;
-				if (m_cvTask.wait_until(taskLock, waitFrom + m_durMaxThreadInactivity) == std::cv_status::timeout)
-					break;
-			}
-			--m_nWaitingThreads;
-			m_nFreeThreads--;
-			if (!pTask)
-				break;
-		}
+		if (std::shared_ptr<base_task> pTask; try_reserve_active_slot()) {
+			if (take_task(self, pTask)) {
+				--m_nIdleThreads;
+				dispatch_task_to_worker();
+
+				do {
+					const auto startedAt = std::chrono::steady_clock::now();
+					self.Task = pTask.get();
+					(*pTask)();
+					self.Task = nullptr;
+					const auto finishedAt = std::chrono::steady_clock::now();
+
+					self.CompletedTasks.fetch_add(1, std::memory_order_relaxed);
+					self.WaitLatency.add(startedAt - pTask->m_submittedAt);
+					self.RunLatency.add(finishedAt - startedAt);
+					if (m_bTracing.load(std::memory_order_acquire) && startedAt >= m_traceStartedAt.load(std::memory_order_relaxed)) {
+						std::lock_guard lock(self.TraceMtx);
+						self.Trace.emplace_back(pTask->m_invokePath, pTask->m_submittedAt, startedAt, finishedAt);
+					}
 
-		taskLock.unlock();
+					pTask.reset();
+				} while (m_nActiveThreads <= m_nConcurrency && take_task(self, pTask));
 
-		dispatch_task_to_worker();
-		(*pTask)();
-		pTask.reset();
+				++m_nIdleThreads;
+			}
+			--m_nActiveThreads;
+		}
 
-		taskLock.lock();
+		if (!wait_for_work(std::chrono::steady_clock::now() + m_durMaxThreadInactivity))
+			break;
 	}
 
-	threadLock.lock();
-	thread.detach();
-	m_mapThreads.erase(it);
+	--m_nIdleThreads;
+	s_pCurrentWorker = nullptr;
+
+	std::lock_guard lock(*pmtxThread);
+	self.Thread.detach();
+	self.Occupied = false;
+	--m_nThreads;
+	++m_nRetiredThreads;
 	m_cvThread.notify_one();
 }
 
 void xivres::util::thread_pool::pool::dispatch_task_to_worker() {
-	if (m_pqTasks.empty())
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_nActiveThreads >= m_nConcurrency || !has_queued_tasks())
 		return;
 
-	if (m_nFreeThreads == 0 && m_mapThreads.size() - m_nWaitingThreads < m_nConcurrency) {
-		std::unique_lock lock(*m_pmtxThread);
-		auto thread = std::thread(&pool::worker_body, this);
-		const auto threadId = thread.get_id();
-		m_mapThreads[threadId].Thread = std::move(thread);
+	if (m_nIdleThreads == 0) {
+		spawn_worker();
+		return;
+	}
+
+	if (m_nSleepingThreads) {
+		std::lock_guard lock(m_mtxIdle);
+		m_cvIdle.notify_one();
+	}
+}
+
+void xivres::util::thread_pool::pool::spawn_worker() {
+	std::lock_guard lock(*m_pmtxThread);
+	if (m_nIdleThreads != 0)
+		return;
+
+	worker* pWorker = nullptr;
+	for (auto p = m_pWorkers.load(std::memory_order_relaxed); p && !pWorker; p = p->Next) {
+		if (!p->Occupied)
+			pWorker = p;
 	}
 
-	m_cvTask.notify_one();
+	if (!pWorker) {
+		pWorker = new worker(*this, m_nWorkerSlots++);
+		pWorker->Next = m_pWorkers.load(std::memory_order_relaxed);
+		m_pWorkers.store(pWorker, std::memory_order_release);
+	}
+
+	pWorker->Occupied = true;
+	++m_nIdleThreads;
+	++m_nThreads;
+	++m_nSpawnedThreads;
+	pWorker->Thread = std::thread([this, pWorker] { worker_body(*pWorker); });
+}
+
+void xivres::util::thread_pool::pool::wake_all_workers() {
+	std::lock_guard lock(m_mtxIdle);
+	m_cvIdle.notify_all();
+}
+
+bool xivres::util::thread_pool::pool::try_reserve_active_slot() {
+	auto nActive = m_nActiveThreads.load();
+	do {
+		if (nActive >= m_nConcurrency)
+			return false;
+	} while (!m_nActiveThreads.compare_exchange_weak(nActive, nActive + 1));
+	return true;
+}
+
+bool xivres::util::thread_pool::pool::has_queued_tasks() const {
+	if (m_nInjectedTasks)
+		return true;
+
+	for (auto pWorker = m_pWorkers.load(std::memory_order_acquire); pWorker; pWorker = pWorker->Next) {
+		if (!pWorker->Queue.empty())
+			return true;
+	}
+
+	return false;
+}
+
+bool xivres::util::thread_pool::pool::take_task(worker& self, std::shared_ptr<base_task>& pTask) {
+	auto pRawTask = self.Queue.pop();
+
+	// Steal from the others, starting next to ourselves so that thieves spread over the victims.
+	const auto pFirst = m_pWorkers.load(std::memory_order_acquire);
+	for (auto pVictim = self.Next ? self.Next : pFirst; !pRawTask && pVictim != &self; pVictim = pVictim->Next ? pVictim->Next : pFirst) {
+		if ((pRawTask = pVictim->Queue.pop()))
+			self.StolenTasks.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if (pRawTask) {
+		pTask = std::move(pRawTask->m_pQueuedSelf);
+		return true;
+	}
+
+	return take_injected_tasks(self, pTask);
+}
+
+bool xivres::util::thread_pool::pool::take_injected_tasks(worker& self, std::shared_ptr<base_task>& pTask) {
+	if (!m_nInjectedTasks)
+		return false;
+
+	std::shared_ptr<base_task> batch[InjectionBatchSize];
+	size_t count;
+	{
+		std::lock_guard lock(m_mtxTask);
+		if (m_pqTasks.empty())
+			return false;
+
+		// Take a fair share of the queue so that a burst of submissions from outside does not make every worker
+		// come back to this lock for each task.
+		count = (std::min)({ InjectionBatchSize, m_pqTasks.size(), m_pqTasks.size() / (std::max<size_t>)(1, m_nConcurrency) + 1 });
+		for (size_t i = 0; i < count; i++) {
+			batch[i] = std::move(const_cast<std::shared_ptr<base_task>&>(m_pqTasks.top()));
+			m_pqTasks.pop();
+		}
+		m_nInjectedTasks = m_pqTasks.size();
+	}
+
+	pTask = std::move(batch[0]);
+
+	// The rest stay visible to thieves; the queue keeps them in invoke path order.
+	for (size_t i = 1; i < count; i++) {
+		const auto pRawTask = batch[i].get();
+		pRawTask->m_pQueuedSelf = std::move(batch[i]);
+		self.Queue.push(pRawTask);
+	}
+
+	return true;
+}
+
+bool xivres::util::thread_pool::pool::wait_for_work(std::chrono::steady_clock::time_point deadline) {
+	std::unique_lock lock(m_mtxIdle);
+	++m_nSleepingThreads;
+	const auto decrementOnExit = on_dtor([this] { --m_nSleepingThreads; });
+
+	while (true) {
+		// Paired with the fence in dispatch_task_to_worker: either we see the new task, or the dispatcher sees us sleeping.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (has_queued_tasks()) {
+			if (m_nActiveThreads < m_nConcurrency)
+				return true;
+		} else if (m_bQuitting) {
+			return false;
+		}
+
+		if (m_cvIdle.wait_until(lock, deadline) == std::cv_status::timeout)
+			return m_nActiveThreads < m_nConcurrency && has_queued_tasks();
+	}
 }
 
 xivres::util::thread_pool::object_pool<std::vector<uint8_t>>::scoped_pooled_object xivres::util::thread_pool::pooled_byte_buffer() {
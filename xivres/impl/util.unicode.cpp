@@ -1,8 +1,13 @@
 #include "../include/xivres/util.unicode.h"
 
 #include <array>
+#include <bit>
 #include <stdexcept>
 
+#if defined(_M_X64) || defined(__x86_64__)
+#include <emmintrin.h>
+#endif
+
 char32_t xivres::util::unicode::u8uint32_to_u32(uint32_t n) {
 	if ((n & 0xFFFFFF80) == 0)
 		return static_cast<char32_t>(n & 0x7F);
@@ -47,6 +52,95 @@ uint32_t xivres::util::unicode::u32_to_u8uint32(char32_t codepoint) {
 		throw std::invalid_argument("Unicode code point is currently capped at 0x10FFFF.");
 }
 
+namespace {
+	template<typename T>
+	size_t count_leading_ascii_impl(const T* in, size_t count) {
+		size_t i = 0;
+
+#if defined(_M_X64) || defined(__x86_64__)
+		constexpr auto UnitsPerVector = 16 / sizeof(T);
+		const auto zero = _mm_setzero_si128();
+		for (; i + UnitsPerVector <= count; i += UnitsPerVector) {
+			const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[i]));
+			int nonAsciiMask;
+			if constexpr (sizeof(T) == 1) {
+				nonAsciiMask = _mm_movemask_epi8(v);
+			} else if constexpr (sizeof(T) == 2) {
+				const auto high = _mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xFF80)));
+				nonAsciiMask = ~_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) & 0xFFFF;
+			} else {
+				const auto high = _mm_and_si128(v, _mm_set1_epi32(static_cast<int>(0xFFFFFF80)));
+				nonAsciiMask = ~_mm_movemask_epi8(_mm_cmpeq_epi32(high, zero)) & 0xFFFF;
+			}
+			if (nonAsciiMask)
+				return i + std::countr_zero(static_cast<uint32_t>(nonAsciiMask)) / sizeof(T);
+		}
+#endif
+
+		while (i < count && static_cast<std::make_unsigned_t<T>>(in[i]) < 0x80)
+			++i;
+		return i;
+	}
+}
+
+size_t xivres::util::unicode::count_leading_ascii(const char8_t* in, size_t count) {
+	return count_leading_ascii_impl(in, count);
+}
+
+size_t xivres::util::unicode::count_leading_ascii(const char16_t* in, size_t count) {
+	return count_leading_ascii_impl(in, count);
+}
+
+size_t xivres::util::unicode::count_leading_ascii(const char32_t* in, size_t count) {
+	return count_leading_ascii_impl(in, count);
+}
+
+size_t xivres::util::unicode::count_leading_ascii(const char* in, size_t count) {
+	return count_leading_ascii_impl(in, count);
+}
+
+size_t xivres::util::unicode::count_leading_ascii(const wchar_t* in, size_t count) {
+	return count_leading_ascii_impl(in, count);
+}
+
+bool xivres::util::unicode::is_valid_utf8(std::u8string_view in) {
+	for (size_t i = 0; i < in.size();) {
+		i += count_leading_ascii(&in[i], in.size() - i);
+		if (i == in.size())
+			break;
+
+		size_t len;
+		char32_t minValue;
+		if ((in[i] & 0xE0) == 0xC0)
+			len = 2, minValue = 0x80;
+		else if ((in[i] & 0xF0) == 0xE0)
+			len = 3, minValue = 0x800;
+		else if ((in[i] & 0xF8) == 0xF0)
+			len = 4, minValue = 0x10000;
+		else
+			return false;
+
+		if (in.size() - i < len)
+			return false;
+
+		auto c = static_cast<char32_t>(in[i] & (0x7F >> len));
+		for (size_t j = 1; j < len; ++j) {
+			if ((in[i + j] & 0xC0) != 0x80)
+				return false;
+			c = (c << 6) | (in[i + j] & 0x3F);
+		}
+
+		if (c < minValue || c > 0x10FFFF || (0xD800 <= c && c <= 0xDFFF))
+			return false;
+		i += len;
+	}
+	return true;
+}
+
+bool xivres::util::unicode::is_valid_utf8(std::string_view in) {
+	return is_valid_utf8(std::u8string_view(reinterpret_cast<const char8_t*>(in.data()), in.size()));
+}
+
 size_t xivres::util::unicode::decode(EncodingTag<char8_t>, char32_t& out, const char8_t* in, size_t nRemainingBytes, bool strict) {
 	if (nRemainingBytes == 0) {
 		out = 0;
@@ -7459,345 +7553,426 @@ char32_t xivres::util::unicode::upper(char32_t in) {
 	return in;
 }
 
-std::span<const xivres::util::unicode::blocks::block_definition> xivres::util::unicode::blocks::all_blocks() {
-	/*
-	 * http://www.util.unicode.org/charts/
-	 * Source: https://util.unicode.org/Public/UNIDATA/Blocks.txt
-	 * Replace from: `^([0-9a-f]+)\.\.([0-9a-f]+); (.*?)$`
-	 * Replace to: `{ 0x$1, 0x$2, "$3", LTR },`
-	 */
-	static const std::array<block_definition, 321> Blocks{ {
-		{ 0x0000, 0x007F, "Basic Latin", LTR | UsedWithCombining },
-		{ 0x0080, 0x00FF, "Latin-1 Supplement", LTR | UsedWithCombining },
-		{ 0x0100, 0x017F, "Latin Extended-A", LTR | UsedWithCombining },
-		{ 0x0180, 0x024F, "Latin Extended-B", LTR | UsedWithCombining },
-		{ 0x0250, 0x02AF, "IPA Extensions", LTR | UsedWithCombining },
-		{ 0x02B0, 0x02FF, "Spacing Modifier Letters", LTR },
-		{ 0x0300, 0x036F, "Combining Diacritical Marks", LTR, Combining },
-		{ 0x0370, 0x03FF, "Greek and Coptic", LTR | UsedWithCombining },
-		{ 0x0400, 0x04FF, "Cyrillic", LTR, Cyrillic },
-		{ 0x0500, 0x052F, "Cyrillic Supplement", LTR, Cyrillic },
-		{ 0x0530, 0x058F, "Armenian", LTR },
-		{ 0x0590, 0x05FF, "Hebrew", RTL },
-		{ 0x0600, 0x06FF, "Arabic", RTL },
-		{ 0x0700, 0x074F, "Syriac", LTR },
-		{ 0x0750, 0x077F, "Arabic Supplement", RTL },
-		{ 0x0780, 0x07BF, "Thaana", LTR },
-		{ 0x07C0, 0x07FF, "NKo", LTR },
-		{ 0x0800, 0x083F, "Samaritan", LTR },
-		{ 0x0840, 0x085F, "Mandaic", LTR },
-		{ 0x0860, 0x086F, "Syriac Supplement", LTR },
-		{ 0x0870, 0x089F, "Arabic Extended-B", RTL },
-		{ 0x08A0, 0x08FF, "Arabic Extended-A", RTL },
-		{ 0x0900, 0x097F, "Devanagari", LTR },
-		{ 0x0980, 0x09FF, "Bengali", LTR },
-		{ 0x0A00, 0x0A7F, "Gurmukhi", LTR },
-		{ 0x0A80, 0x0AFF, "Gujarati", LTR },
-		{ 0x0B00, 0x0B7F, "Oriya", LTR },
-		{ 0x0B80, 0x0BFF, "Tamil", LTR },
-		{ 0x0C00, 0x0C7F, "Telugu", LTR },
-		{ 0x0C80, 0x0CFF, "Kannada", LTR },
-		{ 0x0D00, 0x0D7F, "Malayalam", LTR },
-		{ 0x0D80, 0x0DFF, "Sinhala", LTR },
-		{ 0x0E00, 0x0E7F, "Thai", LTR, Thai },
-		{ 0x0E80, 0x0EFF, "Lao", LTR },
-		{ 0x0F00, 0x0FFF, "Tibetan", LTR },
-		{ 0x1000, 0x109F, "Myanmar", LTR },
-		{ 0x10A0, 0x10FF, "Georgian", LTR },
-		{ 0x1100, 0x11FF, "Hangul Jamo", LTR },
-		{ 0x1200, 0x137F, "Ethiopic", LTR },
-		{ 0x1380, 0x139F, "Ethiopic Supplement", LTR },
-		{ 0x13A0, 0x13FF, "Cherokee", LTR },
-		{ 0x1400, 0x167F, "Unified Canadian Aboriginal Syllabics", LTR },
-		{ 0x1680, 0x169F, "Ogham", LTR },
-		{ 0x16A0, 0x16FF, "Runic", LTR },
-		{ 0x1700, 0x171F, "Tagalog", LTR },
-		{ 0x1720, 0x173F, "Hanunoo", LTR },
-		{ 0x1740, 0x175F, "Buhid", LTR },
-		{ 0x1760, 0x177F, "Tagbanwa", LTR },
-		{ 0x1780, 0x17FF, "Khmer", LTR },
-		{ 0x1800, 0x18AF, "Mongolian", LTR },
-		{ 0x18B0, 0x18FF, "Unified Canadian Aboriginal Syllabics Extended", LTR },
-		{ 0x1900, 0x194F, "Limbu", LTR },
-		{ 0x1950, 0x197F, "Tai Le", LTR },
-		{ 0x1980, 0x19DF, "New Tai Lue", LTR },
-		{ 0x19E0, 0x19FF, "Khmer Symbols", LTR },
-		{ 0x1A00, 0x1A1F, "Buginese", LTR },
-		{ 0x1A20, 0x1AAF, "Tai Tham", LTR },
-		{ 0x1AB0, 0x1AFF, "Combining Diacritical Marks Extended", LTR, Combining },
-		{ 0x1B00, 0x1B7F, "Balinese", LTR },
-		{ 0x1B80, 0x1BBF, "Sundanese", LTR },
-		{ 0x1BC0, 0x1BFF, "Batak", LTR },
-		{ 0x1C00, 0x1C4F, "Lepcha", LTR },
-		{ 0x1C50, 0x1C7F, "Ol Chiki", LTR },
-		{ 0x1C80, 0x1C8F, "Cyrillic Extended-C", LTR, Cyrillic },
-		{ 0x1C90, 0x1CBF, "Georgian Extended", LTR },
-		{ 0x1CC0, 0x1CCF, "Sundanese Supplement", LTR },
-		{ 0x1CD0, 0x1CFF, "Vedic Extensions", LTR },
-		{ 0x1D00, 0x1D7F, "Phonetic Extensions", LTR },
-		{ 0x1D80, 0x1DBF, "Phonetic Extensions Supplement", LTR },
-		{ 0x1DC0, 0x1DFF, "Combining Diacritical Marks Supplement", LTR, Combining },
-		{ 0x1E00, 0x1EFF, "Latin Extended Additional", LTR | UsedWithCombining },
-		{ 0x1F00, 0x1FFF, "Greek Extended", LTR },
-		{ 0x2000, 0x206F, "General Punctuation", LTR },
-		{ 0x2070, 0x209F, "Superscripts and Subscripts", LTR },
-		{ 0x20A0, 0x20CF, "Currency Symbols", LTR },
-		{ 0x20D0, 0x20FF, "Combining Diacritical Marks for Symbols", LTR, Combining },
-		{ 0x2100, 0x214F, "Letterlike Symbols", LTR },
-		{ 0x2150, 0x218F, "Number Forms", LTR },
-		{ 0x2190, 0x21FF, "Arrows", LTR },
-		{ 0x2200, 0x22FF, "Mathematical Operators", LTR },
-		{ 0x2300, 0x23FF, "Miscellaneous Technical", LTR },
-		{ 0x2400, 0x243F, "Control Pictures", LTR },
-		{ 0x2440, 0x245F, "Optical Character Recognition", LTR },
-		{ 0x2460, 0x24FF, "Enclosed Alphanumerics", LTR },
-		{ 0x2500, 0x257F, "Box Drawing", LTR },
-		{ 0x2580, 0x259F, "Block Elements", LTR },
-		{ 0x25A0, 0x25FF, "Geometric Shapes", LTR },
-		{ 0x2600, 0x26FF, "Miscellaneous Symbols", LTR },
-		{ 0x2700, 0x27BF, "Dingbats", LTR },
-		{ 0x27C0, 0x27EF, "Miscellaneous Mathematical Symbols-A", LTR },
-		{ 0x27F0, 0x27FF, "Supplemental Arrows-A", LTR },
-		{ 0x2800, 0x28FF, "Braille Patterns", LTR },
-		{ 0x2900, 0x297F, "Supplemental Arrows-B", LTR },
-		{ 0x2980, 0x29FF, "Miscellaneous Mathematical Symbols-B", LTR },
-		{ 0x2A00, 0x2AFF, "Supplemental Mathematical Operators", LTR },
-		{ 0x2B00, 0x2BFF, "Miscellaneous Symbols and Arrows", LTR },
-		{ 0x2C00, 0x2C5F, "Glagolitic", LTR },
-		{ 0x2C60, 0x2C7F, "Latin Extended-C", LTR | UsedWithCombining },
-		{ 0x2C80, 0x2CFF, "Coptic", LTR },
-		{ 0x2D00, 0x2D2F, "Georgian Supplement", LTR },
-		{ 0x2D30, 0x2D7F, "Tifinagh", LTR },
-		{ 0x2D80, 0x2DDF, "Ethiopic Extended", LTR },
-		{ 0x2DE0, 0x2DFF, "Cyrillic Extended-A", LTR, Cyrillic },
-		{ 0x2E00, 0x2E7F, "Supplemental Punctuation", LTR },
-		{ 0x2E80, 0x2EFF, "CJK Radicals Supplement", LTR },
-		{ 0x2F00, 0x2FDF, "Kangxi Radicals", LTR },
-		{ 0x2FF0, 0x2FFF, "Ideographic Description Characters", LTR },
-		{ 0x3000, 0x303F, "CJK Symbols and Punctuation", LTR },
-		{ 0x3040, 0x309F, "Hiragana", LTR },
-		{ 0x30A0, 0x30FF, "Katakana", LTR },
-		{ 0x3100, 0x312F, "Bopomofo", LTR },
-		{ 0x3130, 0x318F, "Hangul Compatibility Jamo", LTR },
-		{ 0x3190, 0x319F, "Kanbun", LTR },
-		{ 0x31A0, 0x31BF, "Bopomofo Extended", LTR },
-		{ 0x31C0, 0x31EF, "CJK Strokes", LTR },
-		{ 0x31F0, 0x31FF, "Katakana Phonetic Extensions", LTR },
-		{ 0x3200, 0x32FF, "Enclosed CJK Letters and Months", LTR },
-		{ 0x3300, 0x33FF, "CJK Compatibility", LTR },
-		{ 0x3400, 0x4DBF, "CJK Unified Ideographs Extension A", LTR },
-		{ 0x4DC0, 0x4DFF, "Yijing Hexagram Symbols", LTR },
-		{ 0x4E00, 0x9FFF, "CJK Unified Ideographs", LTR },
-		{ 0xA000, 0xA48F, "Yi Syllables", LTR },
-		{ 0xA490, 0xA4CF, "Yi Radicals", LTR },
-		{ 0xA4D0, 0xA4FF, "Lisu", LTR },
-		{ 0xA500, 0xA63F, "Vai", LTR },
-		{ 0xA640, 0xA69F, "Cyrillic Extended-B", LTR, Cyrillic },
-		{ 0xA6A0, 0xA6FF, "Bamum", LTR },
-		{ 0xA700, 0xA71F, "Modifier Tone Letters", LTR },
-		{ 0xA720, 0xA7FF, "Latin Extended-D", LTR | UsedWithCombining },
-		{ 0xA800, 0xA82F, "Syloti Nagri", LTR },
-		{ 0xA830, 0xA83F, "Common Indic Number Forms", LTR },
-		{ 0xA840, 0xA87F, "Phags-pa", LTR },
-		{ 0xA880, 0xA8DF, "Saurashtra", LTR },
-		{ 0xA8E0, 0xA8FF, "Devanagari Extended", LTR },
-		{ 0xA900, 0xA92F, "Kayah Li", LTR },
-		{ 0xA930, 0xA95F, "Rejang", LTR },
-		{ 0xA960, 0xA97F, "Hangul Jamo Extended-A", LTR },
-		{ 0xA980, 0xA9DF, "Javanese", LTR },
-		{ 0xA9E0, 0xA9FF, "Myanmar Extended-B", LTR },
-		{ 0xAA00, 0xAA5F, "Cham", LTR },
-		{ 0xAA60, 0xAA7F, "Myanmar Extended-A", LTR },
-		{ 0xAA80, 0xAADF, "Tai Viet", LTR },
-		{ 0xAAE0, 0xAAFF, "Meetei Mayek Extensions", LTR },
-		{ 0xAB00, 0xAB2F, "Ethiopic Extended-A", LTR },
-		{ 0xAB30, 0xAB6F, "Latin Extended-E", LTR | UsedWithCombining },
-		{ 0xAB70, 0xABBF, "Cherokee Supplement", LTR },
-		{ 0xABC0, 0xABFF, "Meetei Mayek", LTR },
-		{ 0xAC00, 0xD7AF, "Hangul Syllables", LTR },
-		{ 0xD7B0, 0xD7FF, "Hangul Jamo Extended-B", LTR },
-		{ 0xD800, 0xDB7F, "High Surrogates", Invalid },
-		{ 0xDB80, 0xDBFF, "High Private Use Surrogates", Invalid },
-		{ 0xDC00, 0xDFFF, "Low Surrogates", LTR },
-		{ 0xE000, 0xF8FF, "Private Use Area", LTR },
-		{ 0xF900, 0xFAFF, "CJK Compatibility Ideographs", LTR },
-		{ 0xFB00, 0xFB4F, "Alphabetic Presentation Forms", LTR },
-		{ 0xFB50, 0xFDFF, "Arabic Presentation Forms-A", RTL },
-		{ 0xFE00, 0xFE0F, "Variation Selectors", LTR },
-		{ 0xFE10, 0xFE1F, "Vertical Forms", LTR },
-		{ 0xFE20, 0xFE2F, "Combining Half Marks", LTR, Combining },
-		{ 0xFE30, 0xFE4F, "CJK Compatibility Forms", LTR },
-		{ 0xFE50, 0xFE6F, "Small Form Variants", LTR },
-		{ 0xFE70, 0xFEFF, "Arabic Presentation Forms-B", RTL },
-		{ 0xFF00, 0xFFEF, "Halfwidth and Fullwidth Forms", LTR },
-		{ 0xFFF0, 0xFFFF, "Specials", LTR },
-		{ 0x10000, 0x1007F, "Linear B Syllabary", LTR },
-		{ 0x10080, 0x100FF, "Linear B Ideograms", LTR },
-		{ 0x10100, 0x1013F, "Aegean Numbers", LTR },
-		{ 0x10140, 0x1018F, "Ancient Greek Numbers", LTR },
-		{ 0x10190, 0x101CF, "Ancient Symbols", LTR },
-		{ 0x101D0, 0x101FF, "Phaistos Disc", LTR },
-		{ 0x10280, 0x1029F, "Lycian", LTR },
-		{ 0x102A0, 0x102DF, "Carian", LTR },
-		{ 0x102E0, 0x102FF, "Coptic Epact Numbers", LTR },
-		{ 0x10300, 0x1032F, "Old Italic", LTR },
-		{ 0x10330, 0x1034F, "Gothic", LTR },
-		{ 0x10350, 0x1037F, "Old Permic", LTR },
-		{ 0x10380, 0x1039F, "Ugaritic", LTR },
-		{ 0x103A0, 0x103DF, "Old Persian", RTL },
-		{ 0x10400, 0x1044F, "Deseret", LTR },
-		{ 0x10450, 0x1047F, "Shavian", LTR },
-		{ 0x10480, 0x104AF, "Osmanya", LTR },
-		{ 0x104B0, 0x104FF, "Osage", LTR },
-		{ 0x10500, 0x1052F, "Elbasan", LTR },
-		{ 0x10530, 0x1056F, "Caucasian Albanian", LTR },
-		{ 0x10570, 0x105BF, "Vithkuqi", LTR },
-		{ 0x10600, 0x1077F, "Linear A", LTR },
-		{ 0x10780, 0x107BF, "Latin Extended-F", LTR | UsedWithCombining },
-		{ 0x10800, 0x1083F, "Cypriot Syllabary", LTR },
-		{ 0x10840, 0x1085F, "Imperial Aramaic", RTL },
-		{ 0x10860, 0x1087F, "Palmyrene", LTR },
-		{ 0x10880, 0x108AF, "Nabataean", LTR },
-		{ 0x108E0, 0x108FF, "Hatran", LTR },
-		{ 0x10900, 0x1091F, "Phoenician", LTR },
-		{ 0x10920, 0x1093F, "Lydian", LTR },
-		{ 0x10980, 0x1099F, "Meroitic Hieroglyphs", LTR },
-		{ 0x109A0, 0x109FF, "Meroitic Cursive", LTR },
-		{ 0x10A00, 0x10A5F, "Kharoshthi", LTR },
-		{ 0x10A60, 0x10A7F, "Old South Arabian", RTL },
-		{ 0x10A80, 0x10A9F, "Old North Arabian", RTL },
-		{ 0x10AC0, 0x10AFF, "Manichaean", LTR },
-		{ 0x10B00, 0x10B3F, "Avestan", LTR },
-		{ 0x10B40, 0x10B5F, "Inscriptional Parthian", LTR },
-		{ 0x10B60, 0x10B7F, "Inscriptional Pahlavi", LTR },
-		{ 0x10B80, 0x10BAF, "Psalter Pahlavi", LTR },
-		{ 0x10C00, 0x10C4F, "Old Turkic", LTR },
-		{ 0x10C80, 0x10CFF, "Old Hungarian", LTR },
-		{ 0x10D00, 0x10D3F, "Hanifi Rohingya", LTR },
-		{ 0x10E60, 0x10E7F, "Rumi Numeral Symbols", LTR },
-		{ 0x10E80, 0x10EBF, "Yezidi", LTR },
-		{ 0x10F00, 0x10F2F, "Old Sogdian", LTR },
-		{ 0x10F30, 0x10F6F, "Sogdian", LTR },
-		{ 0x10F70, 0x10FAF, "Old Uyghur", LTR },
-		{ 0x10FB0, 0x10FDF, "Chorasmian", LTR },
-		{ 0x10FE0, 0x10FFF, "Elymaic", LTR },
-		{ 0x11000, 0x1107F, "Brahmi", LTR },
-		{ 0x11080, 0x110CF, "Kaithi", LTR },
-		{ 0x110D0, 0x110FF, "Sora Sompeng", LTR },
-		{ 0x11100, 0x1114F, "Chakma", LTR },
-		{ 0x11150, 0x1117F, "Mahajani", LTR },
-		{ 0x11180, 0x111DF, "Sharada", LTR },
-		{ 0x111E0, 0x111FF, "Sinhala Archaic Numbers", LTR },
-		{ 0x11200, 0x1124F, "Khojki", LTR },
-		{ 0x11280, 0x112AF, "Multani", LTR },
-		{ 0x112B0, 0x112FF, "Khudawadi", LTR },
-		{ 0x11300, 0x1137F, "Grantha", LTR },
-		{ 0x11400, 0x1147F, "Newa", LTR },
-		{ 0x11480, 0x114DF, "Tirhuta", LTR },
-		{ 0x11580, 0x115FF, "Siddham", LTR },
-		{ 0x11600, 0x1165F, "Modi", LTR },
-		{ 0x11660, 0x1167F, "Mongolian Supplement", LTR },
-		{ 0x11680, 0x116CF, "Takri", LTR },
-		{ 0x11700, 0x1174F, "Ahom", LTR },
-		{ 0x11800, 0x1184F, "Dogra", LTR },
-		{ 0x118A0, 0x118FF, "Warang Citi", LTR },
-		{ 0x11900, 0x1195F, "Dives Akuru", LTR },
-		{ 0x119A0, 0x119FF, "Nandinagari", LTR },
-		{ 0x11A00, 0x11A4F, "Zanabazar Square", LTR },
-		{ 0x11A50, 0x11AAF, "Soyombo", LTR },
-		{ 0x11AB0, 0x11ABF, "Unified Canadian Aboriginal Syllabics Extended-A", LTR },
-		{ 0x11AC0, 0x11AFF, "Pau Cin Hau", LTR },
-		{ 0x11C00, 0x11C6F, "Bhaiksuki", LTR },
-		{ 0x11C70, 0x11CBF, "Marchen", LTR },
-		{ 0x11D00, 0x11D5F, "Masaram Gondi", LTR },
-		{ 0x11D60, 0x11DAF, "Gunjala Gondi", LTR },
-		{ 0x11EE0, 0x11EFF, "Makasar", LTR },
-		{ 0x11FB0, 0x11FBF, "Lisu Supplement", LTR },
-		{ 0x11FC0, 0x11FFF, "Tamil Supplement", LTR },
-		{ 0x12000, 0x123FF, "Cuneiform", LTR },
-		{ 0x12400, 0x1247F, "Cuneiform Numbers and Punctuation", LTR },
-		{ 0x12480, 0x1254F, "Early Dynastic Cuneiform", LTR },
-		{ 0x12F90, 0x12FFF, "Cypro-Minoan", LTR },
-		{ 0x13000, 0x1342F, "Egyptian Hieroglyphs", LTR },
-		{ 0x13430, 0x1343F, "Egyptian Hieroglyph Format Controls", LTR },
-		{ 0x14400, 0x1467F, "Anatolian Hieroglyphs", LTR },
-		{ 0x16800, 0x16A3F, "Bamum Supplement", LTR },
-		{ 0x16A40, 0x16A6F, "Mro", LTR },
-		{ 0x16A70, 0x16ACF, "Tangsa", LTR },
-		{ 0x16AD0, 0x16AFF, "Bassa Vah", LTR },
-		{ 0x16B00, 0x16B8F, "Pahawh Hmong", LTR },
-		{ 0x16E40, 0x16E9F, "Medefaidrin", LTR },
-		{ 0x16F00, 0x16F9F, "Miao", LTR },
-		{ 0x16FE0, 0x16FFF, "Ideographic Symbols and Punctuation", LTR },
-		{ 0x17000, 0x187FF, "Tangut", LTR },
-		{ 0x18800, 0x18AFF, "Tangut Components", LTR },
-		{ 0x18B00, 0x18CFF, "Khitan Small Script", LTR },
-		{ 0x18D00, 0x18D7F, "Tangut Supplement", LTR },
-		{ 0x1AFF0, 0x1AFFF, "Kana Extended-B", LTR },
-		{ 0x1B000, 0x1B0FF, "Kana Supplement", LTR },
-		{ 0x1B100, 0x1B12F, "Kana Extended-A", LTR },
-		{ 0x1B130, 0x1B16F, "Small Kana Extension", LTR },
-		{ 0x1B170, 0x1B2FF, "Nushu", LTR },
-		{ 0x1BC00, 0x1BC9F, "Duployan", LTR },
-		{ 0x1BCA0, 0x1BCAF, "Shorthand Format Controls", LTR },
-		{ 0x1CF00, 0x1CFCF, "Znamenny Musical Notation", LTR },
-		{ 0x1D000, 0x1D0FF, "Byzantine Musical Symbols", LTR },
-		{ 0x1D100, 0x1D1FF, "Musical Symbols", LTR },
-		{ 0x1D200, 0x1D24F, "Ancient Greek Musical Notation", LTR },
-		{ 0x1D2E0, 0x1D2FF, "Mayan Numerals", LTR },
-		{ 0x1D300, 0x1D35F, "Tai Xuan Jing Symbols", LTR },
-		{ 0x1D360, 0x1D37F, "Counting Rod Numerals", LTR },
-		{ 0x1D400, 0x1D7FF, "Mathematical Alphanumeric Symbols", LTR },
-		{ 0x1D800, 0x1DAAF, "Sutton SignWriting", LTR },
-		{ 0x1DF00, 0x1DFFF, "Latin Extended-G", LTR | UsedWithCombining },
-		{ 0x1E000, 0x1E02F, "Glagolitic Supplement", LTR },
-		{ 0x1E100, 0x1E14F, "Nyiakeng Puachue Hmong", LTR },
-		{ 0x1E290, 0x1E2BF, "Toto", LTR },
-		{ 0x1E2C0, 0x1E2FF, "Wancho", LTR },
-		{ 0x1E7E0, 0x1E7FF, "Ethiopic Extended-B", LTR },
-		{ 0x1E800, 0x1E8DF, "Mende Kikakui", LTR },
-		{ 0x1E900, 0x1E95F, "Adlam", LTR },
-		{ 0x1EC70, 0x1ECBF, "Indic Siyaq Numbers", LTR },
-		{ 0x1ED00, 0x1ED4F, "Ottoman Siyaq Numbers", LTR },
-		{ 0x1EE00, 0x1EEFF, "Arabic Mathematical Alphabetic Symbols", RTL },
-		{ 0x1F000, 0x1F02F, "Mahjong Tiles", LTR },
-		{ 0x1F030, 0x1F09F, "Domino Tiles", LTR },
-		{ 0x1F0A0, 0x1F0FF, "Playing Cards", LTR },
-		{ 0x1F100, 0x1F1FF, "Enclosed Alphanumeric Supplement", LTR },
-		{ 0x1F200, 0x1F2FF, "Enclosed Ideographic Supplement", LTR },
-		{ 0x1F300, 0x1F5FF, "Miscellaneous Symbols and Pictographs", LTR },
-		{ 0x1F600, 0x1F64F, "Emoticons", LTR },
-		{ 0x1F650, 0x1F67F, "Ornamental Dingbats", LTR },
-		{ 0x1F680, 0x1F6FF, "Transport and Map Symbols", LTR },
-		{ 0x1F700, 0x1F77F, "Alchemical Symbols", LTR },
-		{ 0x1F780, 0x1F7FF, "Geometric Shapes Extended", LTR },
-		{ 0x1F800, 0x1F8FF, "Supplemental Arrows-C", LTR },
-		{ 0x1F900, 0x1F9FF, "Supplemental Symbols and Pictographs", LTR },
-		{ 0x1FA00, 0x1FA6F, "Chess Symbols", LTR },
-		{ 0x1FA70, 0x1FAFF, "Symbols and Pictographs Extended-A", LTR },
-		{ 0x1FB00, 0x1FBFF, "Symbols for Legacy Computing", LTR },
-		{ 0x20000, 0x2A6DF, "CJK Unified Ideographs Extension B", LTR },
-		{ 0x2A700, 0x2B73F, "CJK Unified Ideographs Extension C", LTR },
-		{ 0x2B740, 0x2B81F, "CJK Unified Ideographs Extension D", LTR },
-		{ 0x2B820, 0x2CEAF, "CJK Unified Ideographs Extension E", LTR },
-		{ 0x2CEB0, 0x2EBEF, "CJK Unified Ideographs Extension F", LTR },
-		{ 0x2F800, 0x2FA1F, "CJK Compatibility Ideographs Supplement", LTR },
-		{ 0x30000, 0x3134F, "CJK Unified Ideographs Extension G", LTR },
-		{ 0xE0000, 0xE007F, "Tags", LTR },
-		{ 0xE0100, 0xE01EF, "Variation Selectors Supplement", LTR },
-		{ 0xF0000, 0xFFFFF, "Supplementary Private Use Area-A", LTR },
-		{ 0x100000, 0x10FFFF, "Supplementary Private Use Area-B", LTR },
-		{ 0x110000, 0xFFFFFFFF, "Unallocated", Invalid },
-	} };
+namespace xivres::util::unicode::blocks {
+	namespace {
+		/*
+		 * http://www.util.unicode.org/charts/
+		 * Source: https://util.unicode.org/Public/UNIDATA/Blocks.txt
+		 * Replace from: `^([0-9a-f]+)\.\.([0-9a-f]+); (.*?)$`
+		 * Replace to: `{ 0x$1, 0x$2, "$3", LTR },`
+		 */
+		constexpr std::array<block_definition, 321> Blocks{ {
+			{ 0x0000, 0x007F, "Basic Latin", LTR | UsedWithCombining },
+			{ 0x0080, 0x00FF, "Latin-1 Supplement", LTR | UsedWithCombining },
+			{ 0x0100, 0x017F, "Latin Extended-A", LTR | UsedWithCombining },
+			{ 0x0180, 0x024F, "Latin Extended-B", LTR | UsedWithCombining },
+			{ 0x0250, 0x02AF, "IPA Extensions", LTR | UsedWithCombining },
+			{ 0x02B0, 0x02FF, "Spacing Modifier Letters", LTR },
+			{ 0x0300, 0x036F, "Combining Diacritical Marks", LTR, Combining },
+			{ 0x0370, 0x03FF, "Greek and Coptic", LTR | UsedWithCombining },
+			{ 0x0400, 0x04FF, "Cyrillic", LTR, Cyrillic },
+			{ 0x0500, 0x052F, "Cyrillic Supplement", LTR, Cyrillic },
+			{ 0x0530, 0x058F, "Armenian", LTR },
+			{ 0x0590, 0x05FF, "Hebrew", RTL },
+			{ 0x0600, 0x06FF, "Arabic", RTL },
+			{ 0x0700, 0x074F, "Syriac", LTR },
+			{ 0x0750, 0x077F, "Arabic Supplement", RTL },
+			{ 0x0780, 0x07BF, "Thaana", LTR },
+			{ 0x07C0, 0x07FF, "NKo", LTR },
+			{ 0x0800, 0x083F, "Samaritan", LTR },
+			{ 0x0840, 0x085F, "Mandaic", LTR },
+			{ 0x0860, 0x086F, "Syriac Supplement", LTR },
+			{ 0x0870, 0x089F, "Arabic Extended-B", RTL },
+			{ 0x08A0, 0x08FF, "Arabic Extended-A", RTL },
+			{ 0x0900, 0x097F, "Devanagari", LTR },
+			{ 0x0980, 0x09FF, "Bengali", LTR },
+			{ 0x0A00, 0x0A7F, "Gurmukhi", LTR },
+			{ 0x0A80, 0x0AFF, "Gujarati", LTR },
+			{ 0x0B00, 0x0B7F, "Oriya", LTR },
+			{ 0x0B80, 0x0BFF, "Tamil", LTR },
+			{ 0x0C00, 0x0C7F, "Telugu", LTR },
+			{ 0x0C80, 0x0CFF, "Kannada", LTR },
+			{ 0x0D00, 0x0D7F, "Malayalam", LTR },
+			{ 0x0D80, 0x0DFF, "Sinhala", LTR },
+			{ 0x0E00, 0x0E7F, "Thai", LTR, Thai },
+			{ 0x0E80, 0x0EFF, "Lao", LTR },
+			{ 0x0F00, 0x0FFF, "Tibetan", LTR },
+			{ 0x1000, 0x109F, "Myanmar", LTR },
+			{ 0x10A0, 0x10FF, "Georgian", LTR },
+			{ 0x1100, 0x11FF, "Hangul Jamo", LTR },
+			{ 0x1200, 0x137F, "Ethiopic", LTR },
+			{ 0x1380, 0x139F, "Ethiopic Supplement", LTR },
+			{ 0x13A0, 0x13FF, "Cherokee", LTR },
+			{ 0x1400, 0x167F, "Unified Canadian Aboriginal Syllabics", LTR },
+			{ 0x1680, 0x169F, "Ogham", LTR },
+			{ 0x16A0, 0x16FF, "Runic", LTR },
+			{ 0x1700, 0x171F, "Tagalog", LTR },
+			{ 0x1720, 0x173F, "Hanunoo", LTR },
+			{ 0x1740, 0x175F, "Buhid", LTR },
+			{ 0x1760, 0x177F, "Tagbanwa", LTR },
+			{ 0x1780, 0x17FF, "Khmer", LTR },
+			{ 0x1800, 0x18AF, "Mongolian", LTR },
+			{ 0x18B0, 0x18FF, "Unified Canadian Aboriginal Syllabics Extended", LTR },
+			{ 0x1900, 0x194F, "Limbu", LTR },
+			{ 0x1950, 0x197F, "Tai Le", LTR },
+			{ 0x1980, 0x19DF, "New Tai Lue", LTR },
+			{ 0x19E0, 0x19FF, "Khmer Symbols", LTR },
+			{ 0x1A00, 0x1A1F, "Buginese", LTR },
+			{ 0x1A20, 0x1AAF, "Tai Tham", LTR },
+			{ 0x1AB0, 0x1AFF, "Combining Diacritical Marks Extended", LTR, Combining },
+			{ 0x1B00, 0x1B7F, "Balinese", LTR },
+			{ 0x1B80, 0x1BBF, "Sundanese", LTR },
+			{ 0x1BC0, 0x1BFF, "Batak", LTR },
+			{ 0x1C00, 0x1C4F, "Lepcha", LTR },
+			{ 0x1C50, 0x1C7F, "Ol Chiki", LTR },
+			{ 0x1C80, 0x1C8F, "Cyrillic Extended-C", LTR, Cyrillic },
+			{ 0x1C90, 0x1CBF, "Georgian Extended", LTR },
+			{ 0x1CC0, 0x1CCF, "Sundanese Supplement", LTR },
+			{ 0x1CD0, 0x1CFF, "Vedic Extensions", LTR },
+			{ 0x1D00, 0x1D7F, "Phonetic Extensions", LTR },
+			{ 0x1D80, 0x1DBF, "Phonetic Extensions Supplement", LTR },
+			{ 0x1DC0, 0x1DFF, "Combining Diacritical Marks Supplement", LTR, Combining },
+			{ 0x1E00, 0x1EFF, "Latin Extended Additional", LTR | UsedWithCombining },
+			{ 0x1F00, 0x1FFF, "Greek Extended", LTR },
+			{ 0x2000, 0x206F, "General Punctuation", LTR },
+			{ 0x2070, 0x209F, "Superscripts and Subscripts", LTR },
+			{ 0x20A0, 0x20CF, "Currency Symbols", LTR },
+			{ 0x20D0, 0x20FF, "Combining Diacritical Marks for Symbols", LTR, Combining },
+			{ 0x2100, 0x214F, "Letterlike Symbols", LTR },
+			{ 0x2150, 0x218F, "Number Forms", LTR },
+			{ 0x2190, 0x21FF, "Arrows", LTR },
+			{ 0x2200, 0x22FF, "Mathematical Operators", LTR },
+			{ 0x2300, 0x23FF, "Miscellaneous Technical", LTR },
+			{ 0x2400, 0x243F, "Control Pictures", LTR },
+			{ 0x2440, 0x245F, "Optical Character Recognition", LTR },
+			{ 0x2460, 0x24FF, "Enclosed Alphanumerics", LTR },
+			{ 0x2500, 0x257F, "Box Drawing", LTR },
+			{ 0x2580, 0x259F, "Block Elements", LTR },
+			{ 0x25A0, 0x25FF, "Geometric Shapes", LTR },
+			{ 0x2600, 0x26FF, "Miscellaneous Symbols", LTR },
+			{ 0x2700, 0x27BF, "Dingbats", LTR },
+			{ 0x27C0, 0x27EF, "Miscellaneous Mathematical Symbols-A", LTR },
+			{ 0x27F0, 0x27FF, "Supplemental Arrows-A", LTR },
+			{ 0x2800, 0x28FF, "Braille Patterns", LTR },
+			{ 0x2900, 0x297F, "Supplemental Arrows-B", LTR },
+			{ 0x2980, 0x29FF, "Miscellaneous Mathematical Symbols-B", LTR },
+			{ 0x2A00, 0x2AFF, "Supplemental Mathematical Operators", LTR },
+			{ 0x2B00, 0x2BFF, "Miscellaneous Symbols and Arrows", LTR },
+			{ 0x2C00, 0x2C5F, "Glagolitic", LTR },
+			{ 0x2C60, 0x2C7F, "Latin Extended-C", LTR | UsedWithCombining },
+			{ 0x2C80, 0x2CFF, "Coptic", LTR },
+			{ 0x2D00, 0x2D2F, "Georgian Supplement", LTR },
+			{ 0x2D30, 0x2D7F, "Tifinagh", LTR },
+			{ 0x2D80, 0x2DDF, "Ethiopic Extended", LTR },
+			{ 0x2DE0, 0x2DFF, "Cyrillic Extended-A", LTR, Cyrillic },
+			{ 0x2E00, 0x2E7F, "Supplemental Punctuation", LTR },
+			{ 0x2E80, 0x2EFF, "CJK Radicals Supplement", LTR },
+			{ 0x2F00, 0x2FDF, "Kangxi Radicals", LTR },
+			{ 0x2FF0, 0x2FFF, "Ideographic Description Characters", LTR },
+			{ 0x3000, 0x303F, "CJK Symbols and Punctuation", LTR },
+			{ 0x3040, 0x309F, "Hiragana", LTR },
+			{ 0x30A0, 0x30FF, "Katakana", LTR },
+			{ 0x3100, 0x312F, "Bopomofo", LTR },
+			{ 0x3130, 0x318F, "Hangul Compatibility Jamo", LTR },
+			{ 0x3190, 0x319F, "Kanbun", LTR },
+			{ 0x31A0, 0x31BF, "Bopomofo Extended", LTR },
+			{ 0x31C0, 0x31EF, "CJK Strokes", LTR },
+			{ 0x31F0, 0x31FF, "Katakana Phonetic Extensions", LTR },
+			{ 0x3200, 0x32FF, "Enclosed CJK Letters and Months", LTR },
+			{ 0x3300, 0x33FF, "CJK Compatibility", LTR },
+			{ 0x3400, 0x4DBF, "CJK Unified Ideographs Extension A", LTR },
+			{ 0x4DC0, 0x4DFF, "Yijing Hexagram Symbols", LTR },
+			{ 0x4E00, 0x9FFF, "CJK Unified Ideographs", LTR },
+			{ 0xA000, 0xA48F, "Yi Syllables", LTR },
+			{ 0xA490, 0xA4CF, "Yi Radicals", LTR },
+			{ 0xA4D0, 0xA4FF, "Lisu", LTR },
+			{ 0xA500, 0xA63F, "Vai", LTR },
+			{ 0xA640, 0xA69F, "Cyrillic Extended-B", LTR, Cyrillic },
+			{ 0xA6A0, 0xA6FF, "Bamum", LTR },
+			{ 0xA700, 0xA71F, "Modifier Tone Letters", LTR },
+			{ 0xA720, 0xA7FF, "Latin Extended-D", LTR | UsedWithCombining },
+			{ 0xA800, 0xA82F, "Syloti Nagri", LTR },
+			{ 0xA830, 0xA83F, "Common Indic Number Forms", LTR },
+			{ 0xA840, 0xA87F, "Phags-pa", LTR },
+			{ 0xA880, 0xA8DF, "Saurashtra", LTR },
+			{ 0xA8E0, 0xA8FF, "Devanagari Extended", LTR },
+			{ 0xA900, 0xA92F, "Kayah Li", LTR },
+			{ 0xA930, 0xA95F, "Rejang", LTR },
+			{ 0xA960, 0xA97F, "Hangul Jamo Extended-A", LTR },
+			{ 0xA980, 0xA9DF, "Javanese", LTR },
+			{ 0xA9E0, 0xA9FF, "Myanmar Extended-B", LTR },
+			{ 0xAA00, 0xAA5F, "Cham", LTR },
+			{ 0xAA60, 0xAA7F, "Myanmar Extended-A", LTR },
+			{ 0xAA80, 0xAADF, "Tai Viet", LTR },
+			{ 0xAAE0, 0xAAFF, "Meetei Mayek Extensions", LTR },
+			{ 0xAB00, 0xAB2F, "Ethiopic Extended-A", LTR },
+			{ 0xAB30, 0xAB6F, "Latin Extended-E", LTR | UsedWithCombining },
+			{ 0xAB70, 0xABBF, "Cherokee Supplement", LTR },
+			{ 0xABC0, 0xABFF, "Meetei Mayek", LTR },
+			{ 0xAC00, 0xD7AF, "Hangul Syllables", LTR },
+			{ 0xD7B0, 0xD7FF, "Hangul Jamo Extended-B", LTR },
+			{ 0xD800, 0xDB7F, "High Surrogates", Invalid },
+			{ 0xDB80, 0xDBFF, "High Private Use Surrogates", Invalid },
+			{ 0xDC00, 0xDFFF, "Low Surrogates", LTR },
+			{ 0xE000, 0xF8FF, "Private Use Area", LTR },
+			{ 0xF900, 0xFAFF, "CJK Compatibility Ideographs", LTR },
+			{ 0xFB00, 0xFB4F, "Alphabetic Presentation Forms", LTR },
+			{ 0xFB50, 0xFDFF, "Arabic Presentation Forms-A", RTL },
+			{ 0xFE00, 0xFE0F, "Variation Selectors", LTR },
+			{ 0xFE10, 0xFE1F, "Vertical Forms", LTR },
+			{ 0xFE20, 0xFE2F, "Combining Half Marks", LTR, Combining },
+			{ 0xFE30, 0xFE4F, "CJK Compatibility Forms", LTR },
+			{ 0xFE50, 0xFE6F, "Small Form Variants", LTR },
+			{ 0xFE70, 0xFEFF, "Arabic Presentation Forms-B", RTL },
+			{ 0xFF00, 0xFFEF, "Halfwidth and Fullwidth Forms", LTR },
+			{ 0xFFF0, 0xFFFF, "Specials", LTR },
+			{ 0x10000, 0x1007F, "Linear B Syllabary", LTR },
+			{ 0x10080, 0x100FF, "Linear B Ideograms", LTR },
+			{ 0x10100, 0x1013F, "Aegean Numbers", LTR },
+			{ 0x10140, 0x1018F, "Ancient Greek Numbers", LTR },
+			{ 0x10190, 0x101CF, "Ancient Symbols", LTR },
+			{ 0x101D0, 0x101FF, "Phaistos Disc", LTR },
+			{ 0x10280, 0x1029F, "Lycian", LTR },
+			{ 0x102A0, 0x102DF, "Carian", LTR },
+			{ 0x102E0, 0x102FF, "Coptic Epact Numbers", LTR },
+			{ 0x10300, 0x1032F, "Old Italic", LTR },
+			{ 0x10330, 0x1034F, "Gothic", LTR },
+			{ 0x10350, 0x1037F, "Old Permic", LTR },
+			{ 0x10380, 0x1039F, "Ugaritic", LTR },
+			{ 0x103A0, 0x103DF, "Old Persian", RTL },
+			{ 0x10400, 0x1044F, "Deseret", LTR },
+			{ 0x10450, 0x1047F, "Shavian", LTR },
+			{ 0x10480, 0x104AF, "Osmanya", LTR },
+			{ 0x104B0, 0x104FF, "Osage", LTR },
+			{ 0x10500, 0x1052F, "Elbasan", LTR },
+			{ 0x10530, 0x1056F, "Caucasian Albanian", LTR },
+			{ 0x10570, 0x105BF, "Vithkuqi", LTR },
+			{ 0x10600, 0x1077F, "Linear A", LTR },
+			{ 0x10780, 0x107BF, "Latin Extended-F", LTR | UsedWithCombining },
+			{ 0x10800, 0x1083F, "Cypriot Syllabary", LTR },
+			{ 0x10840, 0x1085F, "Imperial Aramaic", RTL },
+			{ 0x10860, 0x1087F, "Palmyrene", LTR },
+			{ 0x10880, 0x108AF, "Nabataean", LTR },
+			{ 0x108E0, 0x108FF, "Hatran", LTR },
+			{ 0x10900, 0x1091F, "Phoenician", LTR },
+			{ 0x10920, 0x1093F, "Lydian", LTR },
+			{ 0x10980, 0x1099F, "Meroitic Hieroglyphs", LTR },
+			{ 0x109A0, 0x109FF, "Meroitic Cursive", LTR },
+			{ 0x10A00, 0x10A5F, "Kharoshthi", LTR },
+			{ 0x10A60, 0x10A7F, "Old South Arabian", RTL },
+			{ 0x10A80, 0x10A9F, "Old North Arabian", RTL },
+			{ 0x10AC0, 0x10AFF, "Manichaean", LTR },
+			{ 0x10B00, 0x10B3F, "Avestan", LTR },
+			{ 0x10B40, 0x10B5F, "Inscriptional Parthian", LTR },
+			{ 0x10B60, 0x10B7F, "Inscriptional Pahlavi", LTR },
+			{ 0x10B80, 0x10BAF, "Psalter Pahlavi", LTR },
+			{ 0x10C00, 0x10C4F, "Old Turkic", LTR },
+			{ 0x10C80, 0x10CFF, "Old Hungarian", LTR },
+			{ 0x10D00, 0x10D3F, "Hanifi Rohingya", LTR },
+			{ 0x10E60, 0x10E7F, "Rumi Numeral Symbols", LTR },
+			{ 0x10E80, 0x10EBF, "Yezidi", LTR },
+			{ 0x10F00, 0x10F2F, "Old Sogdian", LTR },
+			{ 0x10F30, 0x10F6F, "Sogdian", LTR },
+			{ 0x10F70, 0x10FAF, "Old Uyghur", LTR },
+			{ 0x10FB0, 0x10FDF, "Chorasmian", LTR },
+			{ 0x10FE0, 0x10FFF, "Elymaic", LTR },
+			{ 0x11000, 0x1107F, "Brahmi", LTR },
+			{ 0x11080, 0x110CF, "Kaithi", LTR },
+			{ 0x110D0, 0x110FF, "Sora Sompeng", LTR },
+			{ 0x11100, 0x1114F, "Chakma", LTR },
+			{ 0x11150, 0x1117F, "Mahajani", LTR },
+			{ 0x11180, 0x111DF, "Sharada", LTR },
+			{ 0x111E0, 0x111FF, "Sinhala Archaic Numbers", LTR },
+			{ 0x11200, 0x1124F, "Khojki", LTR },
+			{ 0x11280, 0x112AF, "Multani", LTR },
+			{ 0x112B0, 0x112FF, "Khudawadi", LTR },
+			{ 0x11300, 0x1137F, "Grantha", LTR },
+			{ 0x11400, 0x1147F, "Newa", LTR },
+			{ 0x11480, 0x114DF, "Tirhuta", LTR },
+			{ 0x11580, 0x115FF, "Siddham", LTR },
+			{ 0x11600, 0x1165F, "Modi", LTR },
+			{ 0x11660, 0x1167F, "Mongolian Supplement", LTR },
+			{ 0x11680, 0x116CF, "Takri", LTR },
+			{ 0x11700, 0x1174F, "Ahom", LTR },
+			{ 0x11800, 0x1184F, "Dogra", LTR },
+			{ 0x118A0, 0x118FF, "Warang Citi", LTR },
+			{ 0x11900, 0x1195F, "Dives Akuru", LTR },
+			{ 0x119A0, 0x119FF, "Nandinagari", LTR },
+			{ 0x11A00, 0x11A4F, "Zanabazar Square", LTR },
+			{ 0x11A50, 0x11AAF, "Soyombo", LTR },
+			{ 0x11AB0, 0x11ABF, "Unified Canadian Aboriginal Syllabics Extended-A", LTR },
+			{ 0x11AC0, 0x11AFF, "Pau Cin Hau", LTR },
+			{ 0x11C00, 0x11C6F, "Bhaiksuki", LTR },
+			{ 0x11C70, 0x11CBF, "Marchen", LTR },
+			{ 0x11D00, 0x11D5F, "Masaram Gondi", LTR },
+			{ 0x11D60, 0x11DAF, "Gunjala Gondi", LTR },
+			{ 0x11EE0, 0x11EFF, "Makasar", LTR },
+			{ 0x11FB0, 0x11FBF, "Lisu Supplement", LTR },
+			{ 0x11FC0, 0x11FFF, "Tamil Supplement", LTR },
+			{ 0x12000, 0x123FF, "Cuneiform", LTR },
+			{ 0x12400, 0x1247F, "Cuneiform Numbers and Punctuation", LTR },
+			{ 0x12480, 0x1254F, "Early Dynastic Cuneiform", LTR },
+			{ 0x12F90, 0x12FFF, "Cypro-Minoan", LTR },
+			{ 0x13000, 0x1342F, "Egyptian Hieroglyphs", LTR },
+			{ 0x13430, 0x1343F, "Egyptian Hieroglyph Format Controls", LTR },
+			{ 0x14400, 0x1467F, "Anatolian Hieroglyphs", LTR },
+			{ 0x16800, 0x16A3F, "Bamum Supplement", LTR },
+			{ 0x16A40, 0x16A6F, "Mro", LTR },
+			{ 0x16A70, 0x16ACF, "Tangsa", LTR },
+			{ 0x16AD0, 0x16AFF, "Bassa Vah", LTR },
+			{ 0x16B00, 0x16B8F, "Pahawh Hmong", LTR },
+			{ 0x16E40, 0x16E9F, "Medefaidrin", LTR },
+			{ 0x16F00, 0x16F9F, "Miao", LTR },
+			{ 0x16FE0, 0x16FFF, "Ideographic Symbols and Punctuation", LTR },
+			{ 0x17000, 0x187FF, "Tangut", LTR },
+			{ 0x18800, 0x18AFF, "Tangut Components", LTR },
+			{ 0x18B00, 0x18CFF, "Khitan Small Script", LTR },
+			{ 0x18D00, 0x18D7F, "Tangut Supplement", LTR },
+			{ 0x1AFF0, 0x1AFFF, "Kana Extended-B", LTR },
+			{ 0x1B000, 0x1B0FF, "Kana Supplement", LTR },
+			{ 0x1B100, 0x1B12F, "Kana Extended-A", LTR },
+			{ 0x1B130, 0x1B16F, "Small Kana Extension", LTR },
+			{ 0x1B170, 0x1B2FF, "Nushu", LTR },
+			{ 0x1BC00, 0x1BC9F, "Duployan", LTR },
+			{ 0x1BCA0, 0x1BCAF, "Shorthand Format Controls", LTR },
+			{ 0x1CF00, 0x1CFCF, "Znamenny Musical Notation", LTR },
+			{ 0x1D000, 0x1D0FF, "Byzantine Musical Symbols", LTR },
+			{ 0x1D100, 0x1D1FF, "Musical Symbols", LTR },
+			{ 0x1D200, 0x1D24F, "Ancient Greek Musical Notation", LTR },
+			{ 0x1D2E0, 0x1D2FF, "Mayan Numerals", LTR },
+			{ 0x1D300, 0x1D35F, "Tai Xuan Jing Symbols", LTR },
+			{ 0x1D360, 0x1D37F, "Counting Rod Numerals", LTR },
+			{ 0x1D400, 0x1D7FF, "Mathematical Alphanumeric Symbols", LTR },
+			{ 0x1D800, 0x1DAAF, "Sutton SignWriting", LTR },
+			{ 0x1DF00, 0x1DFFF, "Latin Extended-G", LTR | UsedWithCombining },
+			{ 0x1E000, 0x1E02F, "Glagolitic Supplement", LTR },
+			{ 0x1E100, 0x1E14F, "Nyiakeng Puachue Hmong", LTR },
+			{ 0x1E290, 0x1E2BF, "Toto", LTR },
+			{ 0x1E2C0, 0x1E2FF, "Wancho", LTR },
+			{ 0x1E7E0, 0x1E7FF, "Ethiopic Extended-B", LTR },
+			{ 0x1E800, 0x1E8DF, "Mende Kikakui", LTR },
+			{ 0x1E900, 0x1E95F, "Adlam", LTR },
+			{ 0x1EC70, 0x1ECBF, "Indic Siyaq Numbers", LTR },
+			{ 0x1ED00, 0x1ED4F, "Ottoman Siyaq Numbers", LTR },
+			{ 0x1EE00, 0x1EEFF, "Arabic Mathematical Alphabetic Symbols", RTL },
+			{ 0x1F000, 0x1F02F, "Mahjong Tiles", LTR },
+			{ 0x1F030, 0x1F09F, "Domino Tiles", LTR },
+			{ 0x1F0A0, 0x1F0FF, "Playing Cards", LTR },
+			{ 0x1F100, 0x1F1FF, "Enclosed Alphanumeric Supplement", LTR },
+			{ 0x1F200, 0x1F2FF, "Enclosed Ideographic Supplement", LTR },
+			{ 0x1F300, 0x1F5FF, "Miscellaneous Symbols and Pictographs", LTR },
+			{ 0x1F600, 0x1F64F, "Emoticons", LTR },
+			{ 0x1F650, 0x1F67F, "Ornamental Dingbats", LTR },
+			{ 0x1F680, 0x1F6FF, "Transport and Map Symbols", LTR },
+			{ 0x1F700, 0x1F77F, "Alchemical Symbols", LTR },
+			{ 0x1F780, 0x1F7FF, "Geometric Shapes Extended", LTR },
+			{ 0x1F800, 0x1F8FF, "Supplemental Arrows-C", LTR },
+			{ 0x1F900, 0x1F9FF, "Supplemental Symbols and Pictographs", LTR },
+			{ 0x1FA00, 0x1FA6F, "Chess Symbols", LTR },
+			{ 0x1FA70, 0x1FAFF, "Symbols and Pictographs Extended-A", LTR },
+			{ 0x1FB00, 0x1FBFF, "Symbols for Legacy Computing", LTR },
+			{ 0x20000, 0x2A6DF, "CJK Unified Ideographs Extension B", LTR },
+			{ 0x2A700, 0x2B73F, "CJK Unified Ideographs Extension C", LTR },
+			{ 0x2B740, 0x2B81F, "CJK Unified Ideographs Extension D", LTR },
+			{ 0x2B820, 0x2CEAF, "CJK Unified Ideographs Extension E", LTR },
+			{ 0x2CEB0, 0x2EBEF, "CJK Unified Ideographs Extension F", LTR },
+			{ 0x2F800, 0x2FA1F, "CJK Compatibility Ideographs Supplement", LTR },
+			{ 0x30000, 0x3134F, "CJK Unified Ideographs Extension G", LTR },
+			{ 0xE0000, 0xE007F, "Tags", LTR },
+			{ 0xE0100, 0xE01EF, "Variation Selectors Supplement", LTR },
+			{ 0xF0000, 0xFFFFF, "Supplementary Private Use Area-A", LTR },
+			{ 0x100000, 0x10FFFF, "Supplementary Private Use Area-B", LTR },
+			{ 0x110000, 0xFFFFFFFF, "Unallocated", Invalid },
+		} };
+
+		// Every block starts and ends on a 16-codepoint boundary, so the block for a codepoint depends only on codepoint >> 4.
+		constexpr char32_t GranuleShift = 4;
+		constexpr char32_t PageShift = 8;
+		constexpr char32_t GranulesPerPage = 1 << (PageShift - GranuleShift);
+		constexpr char32_t CodepointLimit = 0x110000;
+		constexpr uint16_t MixedPageFlag = 0x8000;
+
+		constexpr bool are_blocks_granule_aligned() {
+			for (size_t i = 0; i + 1 < Blocks.size(); ++i) {
+				if (Blocks[i].First & ((1 << GranuleShift) - 1) || (Blocks[i].Last + 1) & ((1 << GranuleShift) - 1))
+					return false;
+				if (i && Blocks[i - 1].Last >= Blocks[i].First)
+					return false;
+			}
+			return Blocks.back().First == CodepointLimit;
+		}
+
+		static_assert(are_blocks_granule_aligned());
+
+		// Walks forward from hint; codepoints must be queried in ascending order.
+		// Codepoints between blocks resolve to the trailing "Unallocated" entry, as block_for always did.
+		constexpr uint16_t find_block_index(char32_t codepoint, size_t& hint) {
+			while (Blocks[hint].Last < codepoint)
+				++hint;
+			return static_cast<uint16_t>(Blocks[hint].First <= codepoint ? hint : Blocks.size() - 1);
+		}
+
+		// Whether the block (or the gap between blocks) containing the start of page ends before the page does.
+		constexpr bool is_mixed_page(char32_t page, size_t& hint) {
+			const auto first = page << PageShift;
+			const auto last = first | ((1 << PageShift) - 1);
+			const auto index = find_block_index(first, hint);
+			if (index == Blocks.size() - 1)
+				return Blocks[hint].First <= last;
+			return Blocks[index].Last < last;
+		}
+
+		constexpr size_t count_mixed_pages() {
+			size_t count = 0;
+			size_t hint = 0;
+			for (char32_t page = 0; page < CodepointLimit >> PageShift; ++page)
+				count += is_mixed_page(page, hint) ? 1 : 0;
+			return count;
+		}
+
+		constexpr auto MixedPageCount = count_mixed_pages();
+
+		struct block_lookup_table {
+			// Block index if MixedPageFlag is not set; otherwise the index of the page's granules in Stage2, divided by GranulesPerPage.
+			std::array<uint16_t, (CodepointLimit >> PageShift)> Stage1{};
+			std::array<uint16_t, MixedPageCount * GranulesPerPage> Stage2{};
+		};
+
+		constexpr block_lookup_table make_block_lookup_table() {
+			block_lookup_table res{};
+			size_t hint = 0;
+			size_t mixedHint = 0;
+			uint16_t mixedPageCount = 0;
+			for (char32_t page = 0; page < CodepointLimit >> PageShift; ++page) {
+				if (!is_mixed_page(page, mixedHint)) {
+					res.Stage1[page] = find_block_index(page << PageShift, hint);
+					continue;
+				}
+
+				res.Stage1[page] = MixedPageFlag | mixedPageCount;
+				for (char32_t g = 0; g < GranulesPerPage; ++g)
+					res.Stage2[mixedPageCount * GranulesPerPage + g] = find_block_index((page << PageShift) | (g << GranuleShift), hint);
+				++mixedPageCount;
+			}
+			return res;
+		}
 
+		constexpr auto BlockLookup = make_block_lookup_table();
+	}
+}
+
+std::span<const xivres::util::unicode::blocks::block_definition> xivres::util::unicode::blocks::all_blocks() {
 	return { Blocks };
 }
 
 const xivres::util::unicode::blocks::block_definition& xivres::util::unicode::blocks::block_for(char32_t codepoint) {
-	auto p = std::lower_bound(all_blocks().begin(), all_blocks().end(), codepoint, [](const block_definition& l, char32_t r) { return l.Last < r; });
-	if (p->First <= codepoint && codepoint <= p->Last)
-		return *p;
+	if (codepoint >= CodepointLimit)
+		return Blocks.back();
 
-	return all_blocks().back();
-}
+	const auto stage1 = BlockLookup.Stage1[codepoint >> PageShift];
+	if (!(stage1 & MixedPageFlag))
+		return Blocks[stage1];
 
+	const auto granule = (codepoint >> GranuleShift) & (GranulesPerPage - 1);
+	return Blocks[BlockLookup.Stage2[(stage1 & ~MixedPageFlag) * GranulesPerPage + granule]];
+}
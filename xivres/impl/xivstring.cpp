@@ -601,3 +601,57 @@ std::string xivres::xivstring::xivexpr_binary::repr() const {
 	res += "</expr>";
 	return res;
 }
+
+xivres::xivstring::xivpayload xivres::xivstring_view::segment::to_payload() const {
+	if (!IsPayload)
+		throw std::invalid_argument("Not a payload segment");
+	return xivstring::xivpayload(Escaped.substr(1, Escaped.size() - 2));
+}
+
+xivres::xivstring_view::iterator::iterator(std::string_view escaped)
+	: m_remaining(escaped) {
+	read_next();
+}
+
+void xivres::xivstring_view::iterator::read_next() {
+	if (m_remaining.empty()) {
+		m_current = {};
+		return;
+	}
+
+	if (m_remaining[0] != xivstring::StartOfText) {
+		const auto length = (std::min)(m_remaining.find(xivstring::StartOfText), m_remaining.size());
+		m_current = {
+			.Escaped = m_remaining.substr(0, length),
+			.Body = m_remaining.substr(0, length),
+		};
+		m_remaining = m_remaining.substr(length);
+		return;
+	}
+
+	if (m_remaining.size() < 3)
+		throw std::invalid_argument("STX occurred but there are less than 3 remaining bytes");
+
+	const auto length = xivstring::xivexpr_uint32(m_remaining.substr(2));
+	const auto bodyOffset = 2 + length.size();
+	if (m_remaining.size() < bodyOffset + *length + 1 || m_remaining[bodyOffset + *length] != xivstring::EndOfText)
+		throw std::invalid_argument("ETX not found");
+
+	m_current = {
+		.IsPayload = true,
+		.PayloadType = static_cast<xivstring::xivpayload_type>(m_remaining[1]),
+		.Escaped = m_remaining.substr(0, bodyOffset + *length + 1),
+		.Body = m_remaining.substr(bodyOffset, *length),
+	};
+	m_remaining = m_remaining.substr(m_current.Escaped.size());
+}
+
+std::string xivres::xivstring_view::text() const {
+	std::string res;
+	res.reserve(m_escaped.size());
+	for (const auto& segment : *this) {
+		if (!segment.IsPayload)
+			res += segment.Body;
+	}
+	return res;
+}
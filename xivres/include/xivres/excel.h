@@ -71,7 +71,38 @@ namespace xivres::excel {
 			uint64_t uint64;
 		};
 
-		xivstring String;
+	private:
+		// Cells resolved by exd::row::reader borrow their string from the row buffer, which m_stringOwner keeps alive;
+		// an owned copy is only made once the string gets modified.
+		std::string_view m_stringView;
+		std::shared_ptr<const void> m_stringOwner;
+		std::optional<xivstring> m_string;
+
+	public:
+		// Iterates text and payload segments of the string without parsing it into an owned copy.
+		[[nodiscard]] xivstring_view string() const {
+			return m_string ? xivstring_view(*m_string) : xivstring_view(m_stringView);
+		}
+
+		cell& string(xivstring s) {
+			m_string = std::move(s);
+			m_stringView = {};
+			m_stringOwner.reset();
+			return *this;
+		}
+
+		// Copies a borrowed string into the cell, and returns it for modification.
+		xivstring& owned_string() {
+			if (!m_string)
+				string(xivstring(std::string(m_stringView)));
+			return *m_string;
+		}
+
+		void borrow_string(std::string_view escaped, std::shared_ptr<const void> owner) {
+			m_string.reset();
+			m_stringView = escaped;
+			m_stringOwner = std::move(owner);
+		}
 	};
 }
 
@@ -195,11 +226,12 @@ namespace xivres::excel::exd::row {
 	class reader {
 		const std::span<const char> m_fixedData;
 		const std::span<const char> m_fullData;
+		const std::shared_ptr<const void> m_dataOwner;
 		mutable std::vector<std::optional<cell>> m_cells;
 
 	public:
 		const std::vector<exh::column>& Columns;
-		reader(std::span<const char> fixedData, std::span<const char> fullData, const std::vector<exh::column>& columns);
+		reader(std::span<const char> fixedData, std::span<const char> fullData, std::shared_ptr<const void> dataOwner, const std::vector<exh::column>& columns);
 		cell& operator[](size_t index) { return resolve_cell(index); }
 		const cell& operator[](size_t index) const { return resolve_cell(index); }
 		cell& at(size_t index);
@@ -373,7 +405,7 @@ namespace xivres::excel::exd::row {
 	class buffer {
 		uint32_t m_rowId;
 		header m_rowHeader;
-		std::vector<char> m_buffer;
+		std::shared_ptr<const std::vector<char>> m_buffer;
 		std::vector<reader> m_rows;
 
 	public:
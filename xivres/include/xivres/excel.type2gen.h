@@ -9,13 +9,28 @@ namespace xivres::excel {
 	class type2gen {
 		static uint32_t calculate_fixed_data_size(const std::vector<exh::column>& columns);
 
+		enum class row_state : uint8_t {
+			Absent,
+			Empty,
+			Present,
+		};
+
+		// Cells of one language, stored column-major; Cells[columnIndex][rowSlot].
+		struct language_table {
+			std::vector<std::vector<cell>> Cells;
+			std::vector<row_state> States;
+		};
+
+		// Sorted by row id; second is the row slot, which is assigned in insertion order and never changes.
+		std::vector<std::pair<uint32_t, uint32_t>> m_rowIndex;
+		std::map<game_language, language_table> m_tables;
+
 	public:
 		const std::string Name;
 		const std::vector<exh::column> Columns;
 		const exh::read_strategy ReadStrategy;
 		const size_t DivideUnit;
 		const uint32_t FixedDataSize;
-		std::map<uint32_t, std::map<game_language, std::vector<cell>>> Data;
 		std::set<uint32_t> DivideAtIds;
 		std::vector<game_language> Languages;
 		std::vector<game_language> FillMissingLanguageFrom;
@@ -24,15 +39,30 @@ namespace xivres::excel {
 
 		void add_language(game_language language);
 
-		[[nodiscard]] const std::vector<cell>& get_row(uint32_t id, game_language language) const;
+		[[nodiscard]] std::vector<uint32_t> row_ids() const;
+
+		[[nodiscard]] bool has_row(uint32_t id, game_language language) const;
+
+		[[nodiscard]] std::vector<cell> get_row(uint32_t id, game_language language) const;
+
+		[[nodiscard]] const cell& get_cell(uint32_t id, game_language language, size_t columnIndex) const;
 
 		void set_row(uint32_t id, game_language language, std::vector<cell> row, bool replace = true);
 
 	private:
-		[[nodiscard]] std::pair<path_spec, std::vector<char>> flush(uint32_t startId, const std::map<uint32_t, std::vector<char>>& rows, game_language language) const;
+		[[nodiscard]] const uint32_t* find_slot(uint32_t id) const;
+
+		[[nodiscard]] uint32_t find_or_add_slot(uint32_t id);
+
+		[[nodiscard]] row_state state_of(uint32_t slot, game_language language) const;
+
+		[[nodiscard]] std::optional<std::pair<path_spec, std::vector<char>>> compile_page(const exh::page& page, std::span<const std::pair<uint32_t, uint32_t>> rows, game_language language) const;
+
+		[[nodiscard]] std::pair<path_spec, std::vector<char>> flush(uint32_t startId, const std::vector<std::pair<uint32_t, std::vector<char>>>& rows, game_language language) const;
 
 	public:
-		[[nodiscard]] std::map<path_spec, std::vector<char>, path_spec::FullPathComparator> compile();
+		/// Builds every (page, language) EXD file concurrently on the current thread pool.
+		[[nodiscard]] std::map<path_spec, std::vector<char>, path_spec::FullPathComparator> compile() const;
 	};
 }
 
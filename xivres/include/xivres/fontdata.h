@@ -1,6 +1,9 @@
 #ifndef XIVRES_Fontdata_H_
 #define XIVRES_Fontdata_H_
 
+#include <atomic>
+#include <mutex>
+
 #include "stream.h"
 #include "util.byte_order.h"
 #include "util.unicode.h"
@@ -128,11 +131,51 @@ namespace xivres::fontdata {
 	static_assert(sizeof kerning_entry == 0x10);
 
 	class stream : public default_base_stream {
+		// Lookup tables built on first get_glyph/get_kerning after the last modification.
+		// Copies start without a table and build their own on demand.
+		class lookup_cache {
+		public:
+			struct kerning_slot {
+				uint64_t Key;
+				int32_t RightOffset;
+			};
+
+			std::mutex Mtx;
+			std::atomic<bool> Ready = false;
+
+			// Index into m_fontTableEntries plus one for every BMP codepoint; 0 if not present.
+			std::vector<uint32_t> Bmp;
+
+			// Open addressing with linear probing; a slot with RightOffset == 0 is empty.
+			std::vector<kerning_slot> Kerning;
+			uint64_t KerningMask = 0;
+
+			lookup_cache() = default;
+			lookup_cache(const lookup_cache&) {}
+			lookup_cache& operator=(const lookup_cache&) {
+				Ready = false;
+				return *this;
+			}
+
+			static uint64_t make_kerning_key(uint32_t leftUtf8, uint32_t rightUtf8) {
+				return (static_cast<uint64_t>(leftUtf8) << 32) | rightUtf8;
+			}
+
+			static uint64_t hash_kerning_key(uint64_t key) {
+				key ^= key >> 29;
+				key *= 0x9E3779B97F4A7C15ULL;
+				return key ^ (key >> 32);
+			}
+		};
+
 		header m_fcsv;
 		glyph_table_header m_fthd;
 		std::vector<glyph_entry> m_fontTableEntries;
 		kerning_header m_knhd;
 		std::vector<kerning_entry> m_kerningEntries;
+		mutable lookup_cache m_lookup;
+
+		const lookup_cache& get_lookup() const;
 
 	public:
 		stream();
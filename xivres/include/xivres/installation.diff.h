@@ -0,0 +1,35 @@
+#ifndef XIVRES_INSTALLATIONDIFF_H_
+#define XIVRES_INSTALLATIONDIFF_H_
+
+#include "installation.h"
+
+namespace xivres {
+	// Lists the files that were added, removed, or changed between two installations, without decompressing anything.
+	//
+	// Entries are matched by their path hashes; text only tells apart entries whose hashes collide. Within a group of
+	// deduplicated entries, which share one locator, hashes are compared as sets, so an unchanged group is never
+	// reported as added and removed entries.
+	// Matched entries at the same data locator with the same allocation are taken as unchanged, unless compareUnmovedEntries
+	// is set; the packed bytes of every other matched pair are compared. Each sqpack is compared in its own task.
+	class installation_diff {
+	public:
+		struct change {
+			path_spec PathSpec;
+			uint32_t PackId;
+
+			// Point into the readers of the compared installations; null for the side that does not have the entry.
+			const sqpack::reader::entry_info* Old;
+			const sqpack::reader::entry_info* New;
+		};
+
+		std::vector<change> Added;
+		std::vector<change> Removed;
+		std::vector<change> Modified;
+
+		installation_diff(const installation& oldInstallation, const installation& newInstallation, bool compareUnmovedEntries = false);
+
+		[[nodiscard]] bool empty() const { return Added.empty() && Removed.empty() && Modified.empty(); }
+	};
+}
+
+#endif
@@ -37,6 +37,10 @@ namespace xivres {
 
 		[[nodiscard]] std::shared_ptr<unpacked_stream> get_file(const path_spec& pathSpec, std::span<uint8_t> obfuscatedHeaderRewrite = {}) const;
 
+		[[nodiscard]] std::shared_ptr<packed_stream> get_file_packed(const hashed_path& path) const;
+
+		[[nodiscard]] std::shared_ptr<unpacked_stream> get_file(const hashed_path& path, std::span<uint8_t> obfuscatedHeaderRewrite = {}) const;
+
 		[[nodiscard]] std::vector<uint32_t> get_sqpack_ids() const;
 
 		[[nodiscard]] const sqpack::reader& get_sqpack(const path_spec& pathSpec) const;
@@ -139,13 +139,20 @@ namespace xivres {
 		}
 	};
 
+	// Trade-off between packing time and packed size, used to pick a deflate level per file type.
+	enum class compression_preference {
+		fastest,
+		balanced,
+		smallest,
+	};
+
+	[[nodiscard]] int compression_level_for(const path_spec& pathSpec, packed::type packedType, compression_preference preference);
+
 	class compressing_packer {
 		const stream& m_stream;
 		const int m_nCompressionLevel;
 		const bool m_bMultithreaded;
 		bool m_bCancel = false;
-		
-		mutable std::optional<memory_stream> m_preloadedStream;
 
 	public:
 		compressing_packer(const stream& strm, int compressionLevel, bool multithreaded)
@@ -182,16 +189,18 @@ namespace xivres {
 		}
 		
 		[[nodiscard]] const stream& unpacked() const {
-			return m_preloadedStream ? *m_preloadedStream : m_stream;
+			return m_stream;
 		}
 
 		[[nodiscard]] int compression_level() const {
 			return m_nCompressionLevel;
 		}
 
-		void preload();
-
 		void compress_block(uint32_t offset, uint32_t length, block_data_t& blockData) const;
+
+		// Compresses blocks given as (offset, length) through a bounded ring of in-flight block buffers, and passes each
+		// block to emit in order. Returns false if cancelled.
+		bool compress_blocks(std::span<const std::pair<uint32_t, uint32_t>> blocks, const std::function<void(size_t index, block_data_t& blockData)>& emit);
 	};
 
 	template<typename TPacker, typename = std::enable_if_t<std::is_base_of_v<compressing_packer, TPacker>>>
@@ -211,6 +220,10 @@ namespace xivres {
 			, m_bMultithreaded(multithreaded) {
 		}
 
+		compressing_packed_stream(xivres::path_spec spec, std::shared_ptr<const stream> strm, compression_preference preference, bool multithreaded = true)
+			: compressing_packed_stream(spec, std::move(strm), compression_level_for(spec, TPacker::Type, preference), multithreaded) {
+		}
+
 		[[nodiscard]] std::streamsize size() const final {
 			ensure_initialized();
 			return m_stream->size();
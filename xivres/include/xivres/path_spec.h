@@ -4,9 +4,14 @@
 #include <cinttypes>
 #include <filesystem>
 #include <format>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <unordered_set>
 
 #include "sqpack.h"
+#include "util.crc32.h"
 #include "util.unicode.h"
 
 namespace xivres {
@@ -26,7 +31,50 @@ namespace xivres {
 			, PartId(partId)
 			, ExpacId(expacId) { }
 
-		sqpack_spec(std::string_view part1, std::string_view part2 = {}, std::string_view part3 = {});
+		sqpack_spec(std::string_view part1, std::string_view part2 = {}, std::string_view part3 = {})
+			: sqpack_spec(from_filename_int(packid_from_parts(part1, part2, part3))) { }
+
+		// Returns the pack id of a path that starts with the given parts; see packid().
+		[[nodiscard]] static constexpr uint32_t packid_from_parts(std::string_view part1, std::string_view part2 = {}, std::string_view part3 = {}) {
+			const auto parse_number = [](std::string_view s) {
+				uint32_t n = 0;
+				for (const auto c : s) {
+					if (c < '0' || c > '9')
+						break;
+					n = n * 10 + static_cast<uint32_t>(c - '0');
+				}
+				return static_cast<uint32_t>(static_cast<uint8_t>(n));
+			};
+			const auto expac_from = [&](std::string_view s) {
+				return s.size() > 2 && s.starts_with("ex") ? parse_number(s.substr(2)) : 0U;
+			};
+
+			if (part1 == "bgcommon")
+				return 0x010000;
+			if (part1 == "bg") {
+				const auto expacId = expac_from(part2);
+				return 0x020000 | (expacId << 8) | (expacId > 0 ? parse_number(part3) : 0U);
+			}
+			if (part1 == "cut")
+				return 0x030000 | (expac_from(part2) << 8);
+			if (part1 == "chara")
+				return 0x040000;
+			if (part1 == "shader")
+				return 0x050000;
+			if (part1 == "ui")
+				return 0x060000;
+			if (part1 == "sound")
+				return 0x070000;
+			if (part1 == "vfx")
+				return 0x080000;
+			if (part1 == "exd")
+				return 0x0a0000;
+			if (part1 == "game_script")
+				return 0x0b0000;
+			if (part1 == "music")
+				return 0x0c0000 | (expac_from(part2) << 8);
+			return 0x000000;
+		}
 
 		static sqpack_spec from_category_int(uint32_t n) {
 			sqpack_spec spec;
@@ -65,6 +113,9 @@ namespace xivres {
 		}
 	};
 
+	struct hashed_path;
+	class compact_path_spec;
+
 	struct path_spec {
 		static constexpr uint32_t EmptyHashValue = 0xFFFFFFFFU;
 		static constexpr uint8_t EmptyId = 0xFF;
@@ -130,6 +181,11 @@ namespace xivres {
 
 		path_spec(const std::filesystem::path& path) : path_spec(path.u8string()) { }
 
+		// Makes a textless path_spec out of precomputed hashes.
+		path_spec(const hashed_path& path);
+
+		path_spec(const compact_path_spec& path);
+
 		friend void swap(path_spec& l, path_spec& r) noexcept {
 			std::swap(l.m_empty, r.m_empty);
 			std::swap(l.m_sqpack, r.m_sqpack);
@@ -368,6 +424,146 @@ namespace xivres {
 	};
 }
 
+namespace xivres {
+	// Hashes of an ASCII path, computed without allocating or going through unicode conversion.
+	// Usable in constant expressions; see operator""_xivpath.
+	struct hashed_path {
+		bool Empty = true;
+		uint32_t PathHash = path_spec::EmptyHashValue;
+		uint32_t NameHash = path_spec::EmptyHashValue;
+		uint32_t FullPathHash = path_spec::EmptyHashValue;
+		uint32_t PackId = 0xFFFFFFFF;
+
+		// Original text, used only to resolve hash collisions. Not owned; paths made from literals point to static storage.
+		std::string_view Text;
+
+		[[nodiscard]] static constexpr hashed_path from(std::string_view fullPath) {
+			for (const auto c : fullPath) {
+				if (static_cast<uint8_t>(c) >= 0x80)
+					throw std::invalid_argument("hashed_path only supports ASCII paths; use path_spec instead");
+			}
+
+			hashed_path res;
+			res.Text = fullPath;
+
+			std::string_view parts[3]{};
+			size_t partCount = 0, firstOffset = 0, lastOffset = 0, lastSize = 0;
+			for (size_t offset = 0; offset <= fullPath.size();) {
+				auto next = fullPath.find_first_of("/\\", offset);
+				if (next == std::string_view::npos)
+					next = fullPath.size();
+				if (next != offset) {
+					if (partCount < 3)
+						parts[partCount] = fullPath.substr(offset, next - offset);
+					if (!partCount)
+						firstOffset = offset;
+					lastOffset = offset;
+					lastSize = next - offset;
+					++partCount;
+				}
+				offset = next + 1;
+			}
+			if (!partCount)
+				return res;
+
+			res.Empty = false;
+			res.PackId = sqpack_spec::packid_from_parts(parts[0], parts[1], parts[2]);
+
+			const auto name = fullPath.substr(lastOffset, lastSize);
+			res.NameHash = ~util::crc32_update_path(0, name);
+			if (partCount == 1) {
+				res.FullPathHash = res.NameHash;
+			} else {
+				const auto pathCrc = util::crc32_update_path(0, fullPath.substr(firstOffset, lastOffset - 1 - firstOffset));
+				res.PathHash = ~pathCrc;
+				res.FullPathHash = ~util::crc32_update_path(util::crc32_update(pathCrc, "/"), name);
+			}
+			return res;
+		}
+
+		[[nodiscard]] sqpack_spec sqpack() const { return sqpack_spec::from_filename_int(PackId); }
+	};
+
+	inline path_spec::path_spec(const hashed_path& path) {
+		if (!path.Empty)
+			*this = path_spec(path.PathHash, path.NameHash, path.FullPathHash, path.sqpack());
+	}
+
+	// Append-only storage for path text, shared by many compact_path_specs. Identical strings are stored once,
+	// and every view handed out stays valid, and null terminated, for as long as the arena lives.
+	class path_arena {
+		static constexpr size_t BlockSize = 65536;
+
+		std::mutex m_mtx;
+		std::vector<std::unique_ptr<char[]>> m_blocks;
+		size_t m_blockUsed = BlockSize;
+		size_t m_sizeBytes = 0;
+		std::unordered_set<std::string_view> m_interned;
+
+	public:
+		path_arena() = default;
+		path_arena(const path_arena&) = delete;
+		path_arena& operator=(const path_arena&) = delete;
+
+		[[nodiscard]] std::string_view intern(std::string_view text);
+
+		[[nodiscard]] size_t size_bytes() const { return m_sizeBytes; }
+	};
+
+	// Fixed-size, trivially copyable form of path_spec, for bulk storage such as sqpack::reader::Entries.
+	// Text, if any, is not owned; it lives in a path_arena that must outlive this.
+	class compact_path_spec {
+		uint32_t m_pathHash = path_spec::EmptyHashValue;
+		uint32_t m_nameHash = path_spec::EmptyHashValue;
+		uint32_t m_fullPathHash = path_spec::EmptyHashValue;
+		sqpack_spec m_sqpack;
+		const char* m_text = nullptr;
+		uint16_t m_textLength = 0;
+		uint16_t m_nameOffset = 0;
+
+	public:
+		compact_path_spec() noexcept = default;
+
+		compact_path_spec(uint32_t pathHash, uint32_t nameHash, uint32_t fullPathHash, sqpack_spec sqpackSpec)
+			: m_pathHash(pathHash)
+			, m_nameHash(nameHash)
+			, m_fullPathHash(fullPathHash)
+			, m_sqpack(sqpackSpec) { }
+
+		compact_path_spec(uint32_t pathHash, uint32_t nameHash, uint32_t fullPathHash, uint8_t categoryId, uint8_t expacId, uint8_t partId)
+			: compact_path_spec(pathHash, nameHash, fullPathHash, sqpack_spec(categoryId, expacId, partId)) { }
+
+		compact_path_spec(const path_spec& pathSpec, path_arena& arena);
+
+		[[nodiscard]] bool empty() const { return m_pathHash == path_spec::EmptyHashValue && m_nameHash == path_spec::EmptyHashValue && m_fullPathHash == path_spec::EmptyHashValue; }
+
+		[[nodiscard]] uint8_t category_id() const { return m_sqpack.category_id(); }
+		[[nodiscard]] uint8_t expac_id() const { return m_sqpack.expac_id(); }
+		[[nodiscard]] uint8_t part_id() const { return m_sqpack.part_id(); }
+		[[nodiscard]] uint32_t packid() const { return m_sqpack.packid(); }
+		[[nodiscard]] uint32_t path_hash() const { return m_pathHash; }
+		[[nodiscard]] uint32_t name_hash() const { return m_nameHash; }
+		[[nodiscard]] uint32_t full_path_hash() const { return m_fullPathHash; }
+
+		[[nodiscard]] bool has_original() const { return m_textLength != 0; }
+		[[nodiscard]] std::string_view text() const { return {m_text, m_textLength}; }
+		[[nodiscard]] std::string_view filename() const { return text().substr(m_nameOffset); }
+	};
+
+	inline path_spec::path_spec(const compact_path_spec& path) {
+		if (path.has_original())
+			*this = path_spec(std::string(path.text()));
+		else if (!path.empty())
+			*this = path_spec(path.path_hash(), path.name_hash(), path.full_path_hash(), sqpack_spec::from_filename_int(path.packid()));
+	}
+
+	namespace literals {
+		consteval hashed_path operator""_xivpath(const char* s, size_t length) {
+			return hashed_path::from(std::string_view(s, length));
+		}
+	}
+}
+
 template<>
 struct std::formatter<xivres::path_spec, char> : std::formatter<std::basic_string<char>, char> {
 	template<class FormatContext>
@@ -92,6 +92,14 @@ namespace xivres::sound {
 	struct sound_entry_ogg_header {
 		static const uint8_t Version3XorTable[256];
 
+		// Decodes the vorbis header of a version 2 entry, in place or from src into dst of the same size.
+		static void decode_version2(std::span<uint8_t> data, uint8_t encodeByte);
+		static void decode_version2(std::span<const uint8_t> src, std::span<uint8_t> dst, uint8_t encodeByte);
+
+		// Decodes a version 3 ogg stream, in place or from src into dst of the same size; data starts at offset bytes into the stream, and streamDataSize is sound_entry_header::StreamSize.
+		static void decode_version3(std::span<uint8_t> data, size_t streamDataSize, size_t offset = 0);
+		static void decode_version3(std::span<const uint8_t> src, std::span<uint8_t> dst, size_t streamDataSize, size_t offset = 0);
+
 		uint8_t Version{};
 		uint8_t HeaderSize{};
 		uint8_t EncodeByte{};
@@ -152,21 +160,31 @@ namespace xivres::sound {
 		const uint32_t m_endOfTable1;
 		const uint32_t m_endOfTable4;
 
+		// Whole file, if the underlying stream is a memory_stream; entries are then borrowed instead of copied.
+		const std::span<const uint8_t> m_view;
+
 		[[nodiscard]] std::vector<uint8_t> read_entry(const std::span<const uint32_t>& offsets, uint32_t endOffset, size_t index) const;
 
 		[[nodiscard]] std::vector<std::vector<uint8_t>> read_table(const std::span<const uint32_t>& offsets, uint32_t endOffset) const;
 
+		[[nodiscard]] std::span<const uint8_t> view_entry(const std::span<const uint32_t>& offsets, uint32_t endOffset, size_t index) const;
+
+		[[nodiscard]] std::vector<std::span<const uint8_t>> view_table(const std::span<const uint32_t>& offsets, uint32_t endOffset) const;
+
 		[[nodiscard]] static std::vector<uint8_t> get_header_bytes(const stream& strm);
 
+		[[nodiscard]] static std::span<const uint8_t> get_memory_view(const stream& strm);
+
 	public:
 		reader(std::shared_ptr<stream> strm);
 
 		struct sound_item {
+			// Empty if the entry is borrowed from the memory_stream backing the reader.
 			std::vector<uint8_t> Buffer;
-			sound_entry_header* Header;
-			std::vector<sound_entry_aux_chunk*> AuxChunks;
-			std::span<uint8_t> ExtraData;
-			std::span<uint8_t> Data;
+			const sound_entry_header* Header;
+			std::vector<const sound_entry_aux_chunk*> AuxChunks;
+			std::span<const uint8_t> ExtraData;
+			std::span<const uint8_t> Data;
 
 			[[nodiscard]] std::vector<uint32_t> marked_sample_block_indices() const;
 
@@ -174,12 +192,21 @@ namespace xivres::sound {
 
 			[[nodiscard]] const adpcm_wave_format& get_adpcm_wav_header() const;
 
+			[[nodiscard]] size_t get_wav_file_size() const;
+
+			void write_wav_file(std::span<uint8_t> out) const;
+
 			[[nodiscard]] std::vector<uint8_t> get_wav_file() const;
 
 			[[nodiscard]] const sound_entry_ogg_header& get_ogg_seek_table_header() const;
 
 			[[nodiscard]] std::span<const uint32_t> get_ogg_seek_table() const;
 
+			[[nodiscard]] size_t get_ogg_file_size() const;
+
+			// Writes the decoded ogg stream to out, which must be exactly get_ogg_file_size() bytes long.
+			void write_ogg_file(std::span<uint8_t> out) const;
+
 			[[nodiscard]] std::vector<uint8_t> get_ogg_file() const;
 
 			struct audio_info {
@@ -210,6 +237,17 @@ namespace xivres::sound {
 
 		[[nodiscard]] std::vector<std::vector<uint8_t>> read_table_5() const { return read_table(m_offsetsTable5, m_endOfTable5); }
 
+		[[nodiscard]] bool is_memory_backed() const { return !m_view.empty(); }
+
+		// view_table_* functions borrow from the underlying memory_stream, and are only usable if is_memory_backed().
+		[[nodiscard]] std::vector<std::span<const uint8_t>> view_table_1() const { return view_table(m_offsetsTable1, m_endOfTable1); }
+
+		[[nodiscard]] std::vector<std::span<const uint8_t>> view_table_2() const { return view_table(m_offsetsTable2, m_endOfTable2); }
+
+		[[nodiscard]] std::vector<std::span<const uint8_t>> view_table_4() const { return view_table(m_offsetsTable4, m_endOfTable4); }
+
+		[[nodiscard]] std::vector<std::span<const uint8_t>> view_table_5() const { return view_table(m_offsetsTable5, m_endOfTable5); }
+
 		[[nodiscard]] size_t sound_item_count() const { return m_soundEntryOffsets.size(); }
 
 		[[nodiscard]] sound_item read_sound_item(size_t entryIndex) const;
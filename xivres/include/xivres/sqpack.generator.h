@@ -10,8 +10,10 @@
 namespace xivres::sqpack {
 	class generator {
 		const uint64_t m_maxFileSize;
+		const bool m_deduplicate;
 
 		class data_view_stream;
+		class preallocated_output_file;
 
 	public:
 		struct entry_info {
@@ -19,6 +21,9 @@ namespace xivres::sqpack {
 			sqindex::data_locator Locator{};
 
 			std::shared_ptr<packed_stream> Provider;
+
+			// SHA-1 of the packed data; set while exporting when deduplication is enabled.
+			std::optional<sha1_value> ContentHash;
 		};
 
 		struct add_result {
@@ -86,10 +91,25 @@ namespace xivres::sqpack {
 		std::vector<sqindex::segment_3_entry> m_sqpackIndexSegment3;
 		std::vector<sqindex::segment_3_entry> m_sqpackIndex2Segment3;
 
+		std::vector<std::pair<path_spec, path_spec>> m_deduplicated;
+
+		// An item of index1 or index2. The two index files are built from separate lists, so that an incremental export
+		// can carry over every item of the previous index files on its own.
+		using index_item = std::pair<const path_spec*, const entry_info*>;
+
+		std::vector<std::pair<path_spec, std::unique_ptr<entry_info>>> take_entries();
+		void export_index_files(const std::filesystem::path& dir, const std::vector<std::pair<path_spec, std::unique_ptr<entry_info>>>& entries, size_t dataFilesCount, bool strict) const;
+		void export_index_files(const std::filesystem::path& dir, std::span<const index_item> index1Items, std::span<const index_item> index2Items, size_t dataFilesCount, bool strict) const;
+		static void verify_index_files(const std::filesystem::path& indexPath, std::span<const index_item> index1Items, std::span<const index_item> index2Items);
+		void resolve_duplicates(const std::vector<std::pair<path_spec, std::unique_ptr<entry_info>>>& entries, std::span<const std::pair<entry_info*, entry_info*>> duplicates);
+		[[nodiscard]] static size_t pack_window_size();
+		[[nodiscard]] static std::vector<uint64_t> resolve_packed_sizes(std::span<entry_info* const> entries, bool hashContent, std::vector<std::vector<char>>& packedData);
+		static void write_entries(std::span<entry_info* const> entries, std::span<const uint64_t> entrySizes, std::span<std::vector<char>> packedData, const std::vector<std::unique_ptr<preallocated_output_file>>& dataFiles, std::span<const std::unique_ptr<util::hash_sha1>> dataSha1);
+
 	public:
 		util::listener_manager<generator, void, size_t, size_t> ProgressCallback;
 
-		generator(std::string ex, std::string name, uint64_t maxFileSize = sqdata::header::MaxFileSize_MaxValue);
+		generator(std::string ex, std::string name, uint64_t maxFileSize = sqdata::header::MaxFileSize_MaxValue, bool deduplicate = false);
 
 		void add(add_result& result, std::shared_ptr<packed_stream> provider, bool overwriteExisting);
 		add_result add(std::shared_ptr<packed_stream> provider, bool overwriteExisting = true);
@@ -98,9 +118,33 @@ namespace xivres::sqpack {
 		add_result add_file(path_spec pathSpec, const std::filesystem::path& path, bool overwriteExisting = true);
 		void reserve_space(path_spec pathSpec, uint32_t size);
 
+		// Does not support deduplication, and throws std::logic_error if this generator was made with it enabled.
 		[[nodiscard]] sqpack_views export_to_views(bool strict, const std::shared_ptr<sqpack_view_entry_cache>& dataBuffer = nullptr);
 		void export_to_files(const std::filesystem::path& dir, bool strict = false, size_t cores = std::thread::hardware_concurrency());
 
+		// Lays out entries ahead of writing them, preallocates the .dat files, and lets worker tasks write packed data
+		// directly at their final offsets. Entries are packed, laid out and written in windows of pack_window_size(),
+		// so only one window of packed data is held in memory at a time, at the cost of growing the .dat files once
+		// per window. Packed sizes must not change between layout and write.
+		void export_to_files_preallocated(const std::filesystem::path& dir, bool strict = false);
+
+		// Updates the sqpack previously exported to dir in place. Entries in this generator are the change set: each one
+		// is appended to the .dat files, every other entry keeps its location and is not rewritten, and the index files
+		// are rebuilt last. Items of the previous index files that no change replaces are carried over as they were, so
+		// the new index files list the same items a full export of the same entries would.
+		// Space of replaced entries is not reused, so that the previous index stays valid until the new one has been
+		// written. As the .dat files therefore only grow, this throws without changing anything if more than a quarter
+		// of their data would be left unused, and throws after putting the .dat files back as they were if the changes
+		// would need more than reader::MaxDataFileCount .dat files; export to another directory then.
+		// In strict mode, each .dat file that gets appended to is read once in full, as its SHA-1 cannot be resumed from
+		// the digest in its header; that part costs as much as in a full export. .dat files without changes are not
+		// read. Every item is also looked up again in the written index files, to check that it resolves where it was put.
+		void export_to_files_incremental(const std::filesystem::path& dir, bool strict = false);
+
+		// Entries that the last export found to have the same packed data as another entry, each paired with the entry
+		// whose space it shares. Only filled when deduplication is enabled; export_to_views throws std::logic_error then.
+		[[nodiscard]] const std::vector<std::pair<path_spec, path_spec>>& deduplicated() const { return m_deduplicated; }
+
 		[[nodiscard]] std::unique_ptr<default_base_stream> get(const path_spec& pathSpec) const;
 		[[nodiscard]] std::vector<path_spec> all_path_spec() const;
 	};
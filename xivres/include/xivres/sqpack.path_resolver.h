@@ -0,0 +1,42 @@
+#ifndef XIVRES_SQPACKPATHRESOLVER_H_
+#define XIVRES_SQPACKPATHRESOLVER_H_
+
+#include <map>
+
+#include "sqpack.reader.h"
+
+namespace xivres::sqpack {
+	// Recovers the text of hash-only entries by expanding candidate path templates.
+	//
+	// Braces in a template hold a placeholder:
+	// * {0001-0099} expands to a decimal range, zero-padded to the width of the lower bound.
+	// * {a,b,c} expands to each of the alternatives.
+	// * {name=...} is either of the above, and lets a later {name} repeat the chosen value.
+	// * {name} repeats a value chosen earlier, or expands to each of Variables[name] on its first use.
+	// Placeholders may not expand to slashes. Templates should be in canonical form, without leading or repeated slashes.
+	class path_resolver {
+		std::vector<uint32_t> m_pathHashes;
+
+		// (path hash << 32 | name hash, full path hash) of entries that have both.
+		std::vector<std::pair<uint64_t, uint32_t>> m_entryHashes;
+
+		// Entries that have only one of the two; a candidate only has to match the hash they have.
+		std::vector<uint64_t> m_pairOnlyHashes;
+		std::vector<uint32_t> m_fullPathOnlyHashes;
+
+	public:
+		std::map<std::string, std::vector<std::string>, std::less<>> Variables;
+
+		path_resolver(const reader& reader, bool unresolvedOnly = true);
+
+		[[nodiscard]] bool contains_path_hash(uint32_t pathHash) const;
+
+		/// Whether the pair hash and the full path hash both belong to the same entry.
+		[[nodiscard]] bool contains(uint32_t pathHash, uint32_t nameHash, uint32_t fullPathHash) const;
+
+		/// Expands pattern on the current thread pool, and returns every expansion that names an entry of the reader.
+		[[nodiscard]] std::vector<path_spec> resolve(std::string_view pattern) const;
+	};
+}
+
+#endif
@@ -5,6 +5,7 @@
 
 #include "unpacked_stream.h"
 #include "sqpack.h"
+#include "util.thread_pool.h"
 
 namespace xivres::sqpack {
 	class reader {
@@ -18,17 +19,9 @@ namespace xivres::sqpack {
 				: Data(std::move(data)) {
 
 				if (strictVerify) {
-					header().verify_or_throw(file_type::SqIndex);
-					index_header().verify_or_throw(sqindex::sqindex_type::Index);
-					if (index_header().HashLocatorSegment.Size % sizeof(HashLocatorT))
-						throw bad_data_error("HashLocators has an invalid size alignment");
-					if (index_header().TextLocatorSegment.Size % sizeof(TextLocatorT))
-						throw bad_data_error("TextLocators has an invalid size alignment");
-					if (index_header().UnknownSegment3.Size % sizeof(sqindex::segment_3_entry))
-						throw bad_data_error("Segment3 has an invalid size alignment");
-					index_header().HashLocatorSegment.Sha1.verify(hash_locators(), "HashLocatorSegment has invalid data SHA-1");
-					index_header().TextLocatorSegment.Sha1.verify(text_locators(), "TextLocatorSegment has invalid data SHA-1");
-					index_header().UnknownSegment3.Sha1.verify(segment_3(), "UnknownSegment3 has invalid data SHA-1");
+					util::thread_pool::task_waiter<bool> waiter;
+					submit_verification(waiter);
+					waiter.wait_all();
 				}
 			}
 
@@ -56,6 +49,31 @@ namespace xivres::sqpack {
 				return util::span_cast<sqindex::segment_3_entry>(Data, index_header().UnknownSegment3.Offset, index_header().UnknownSegment3.Size, 1);
 			}
 
+			/// \brief Checks the headers and segment alignments, and queues a SHA-1 check of each segment into waiter.
+			/// \remarks The caller must drain waiter before this object goes away; failed checks throw from waiter.get().
+			void submit_verification(util::thread_pool::task_waiter<bool>& waiter) const {
+				header().verify_or_throw(file_type::SqIndex);
+				index_header().verify_or_throw(sqindex::sqindex_type::Index);
+				if (index_header().HashLocatorSegment.Size % sizeof(HashLocatorT))
+					throw bad_data_error("HashLocators has an invalid size alignment");
+				if (index_header().TextLocatorSegment.Size % sizeof(TextLocatorT))
+					throw bad_data_error("TextLocators has an invalid size alignment");
+				if (index_header().UnknownSegment3.Size % sizeof(sqindex::segment_3_entry))
+					throw bad_data_error("Segment3 has an invalid size alignment");
+				waiter.submit([this](util::thread_pool::base_task&) {
+					index_header().HashLocatorSegment.Sha1.verify(hash_locators(), "HashLocatorSegment has invalid data SHA-1");
+					return true;
+				});
+				waiter.submit([this](util::thread_pool::base_task&) {
+					index_header().TextLocatorSegment.Sha1.verify(text_locators(), "TextLocatorSegment has invalid data SHA-1");
+					return true;
+				});
+				waiter.submit([this](util::thread_pool::base_task&) {
+					index_header().UnknownSegment3.Sha1.verify(segment_3(), "UnknownSegment3 has invalid data SHA-1");
+					return true;
+				});
+			}
+
 			const sqindex::data_locator* find_data_locator(const char* fullPath) const {
 				const auto it = std::lower_bound(text_locators().begin(), text_locators().end(), fullPath, path_spec::LocatorComparator());
 				if (it == text_locators().end() || _strcmpi(it->FullPath, fullPath) != 0)
@@ -76,6 +94,8 @@ namespace xivres::sqpack {
 
 			[[nodiscard]] std::span<const sqindex::path_hash_locator> pair_hash_locators() const;
 
+			void submit_verification(util::thread_pool::task_waiter<bool>& waiter) const;
+
 			[[nodiscard]] std::span<const sqindex::pair_hash_locator> find_pair_hash_locators_for_path(uint32_t pathHash) const;
 
 			[[nodiscard]] std::span<const sqindex::pair_hash_locator> pair_hash_locators_for_path(uint32_t pathHash) const;
@@ -107,10 +127,24 @@ namespace xivres::sqpack {
 
 		struct entry_info {
 			sqindex::data_locator Locator;
-			path_spec PathSpec;
+			compact_path_spec PathSpec;
 			uint64_t Allocation;
 		};
 
+		/// \brief Packed file header fields of every entry; row i describes Entries[i].
+		/// \remarks Rows whose header could not be read have Type set to packed::type::invalid.
+		struct metadata_table {
+			std::vector<packed::type> Type;
+			std::vector<uint32_t> DecompressedSize;
+			std::vector<uint32_t> BlockCount;
+			std::vector<uint64_t> PackedSize;
+
+			[[nodiscard]] size_t size() const { return Type.size(); }
+		};
+
+		// Holds the text of Entries' paths; shared, so that copies of a reader keep it alive.
+		std::shared_ptr<path_arena> PathArena = std::make_shared<path_arena>();
+
 		sqindex_1_type Index1;
 		sqindex_2_type Index2;
 		std::vector<sqdata_type> Data;
@@ -124,6 +158,9 @@ namespace xivres::sqpack {
 
 		reader(const std::string& fileName, const stream& indexStream1, const stream& indexStream2, std::vector<std::shared_ptr<stream>> dataStreams, bool strictVerify = false);
 
+		// from_path opens .dat0 up to this many .dat files, and ignores any past them.
+		static constexpr size_t MaxDataFileCount = 8;
+
 		static reader from_path(const std::filesystem::path& indexFile, bool strictVerify = false);
 
 		[[nodiscard]] uint32_t pack_id() const { return (CategoryId << 16) | (ExpacId << 8) | PartId; }
@@ -136,17 +173,36 @@ namespace xivres::sqpack {
 
 		[[nodiscard]] const sqindex::data_locator& data_locator_from_index2(const path_spec& pathSpec) const;
 
+		[[nodiscard]] const sqindex::data_locator* find_data_locator_from_index1(const hashed_path& path) const;
+
+		[[nodiscard]] const sqindex::data_locator* find_data_locator_from_index2(const hashed_path& path) const;
+
 		[[nodiscard]] size_t find_entry_index(const path_spec& pathSpec) const;
 
+		[[nodiscard]] size_t find_entry_index(const hashed_path& path) const;
+
 		[[nodiscard]] size_t get_entry_index(const path_spec& pathSpec) const;
 
+		[[nodiscard]] size_t get_entry_index(const hashed_path& path) const;
+
 		[[nodiscard]] std::shared_ptr<packed_stream> packed_at(const entry_info& info) const;
 
 		[[nodiscard]] std::shared_ptr<packed_stream> packed_at(const path_spec& pathSpec) const;
 
+		[[nodiscard]] std::shared_ptr<packed_stream> packed_at(const hashed_path& path) const;
+
 		[[nodiscard]] std::shared_ptr<unpacked_stream> at(const entry_info& info, std::span<uint8_t> obfuscatedHeaderRewrite = {}) const;
 
 		[[nodiscard]] std::shared_ptr<unpacked_stream> at(const path_spec& pathSpec, std::span<uint8_t> obfuscatedHeaderRewrite = {}) const;
+
+		[[nodiscard]] std::shared_ptr<unpacked_stream> at(const hashed_path& path, std::span<uint8_t> obfuscatedHeaderRewrite = {}) const;
+
+		/// \brief Reads the packed file header of every entry, without setting up any unpacker.
+		/// \remarks Each .dat file is scanned in offset order in its own task, merging nearby headers into one read.
+		[[nodiscard]] metadata_table scan_metadata() const;
+
+	private:
+		[[nodiscard]] size_t find_entry_index(const sqindex::data_locator* locator) const;
 	};
 }
 
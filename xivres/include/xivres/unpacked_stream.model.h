@@ -1,6 +1,8 @@
 #ifndef XIVRES_MODELPACKEDFILESTREAMDECODER_H_
 #define XIVRES_MODELPACKEDFILESTREAMDECODER_H_
 
+#include <array>
+
 #include "unpacked_stream.h"
 #include "model.h"
 
@@ -19,13 +21,36 @@ namespace xivres {
 			}
 		};
 
+		struct group_info_t {
+			uint32_t FirstBlockIndex;
+			uint32_t BlockCount;
+			uint32_t DecompressedSize;
+		};
+
 		model::header m_header;
 		std::vector<block_info_t> m_blocks;
 
+		// Indexed in file order: stack, runtime, and then vertex, edge geometry vertex, and index for each LOD.
+		std::array<group_info_t, 11> m_groups{};
+
 	public:
+		struct lod_buffers {
+			std::vector<uint8_t> Vertex;
+			std::vector<uint8_t> EdgeGeometryVertex;
+			std::vector<uint8_t> Index;
+		};
+
 		model_unpacker(const packed::file_header& header, std::shared_ptr<const packed_stream> strm);
 
 		std::streamsize read(std::streamoff offset, void* buf, std::streamsize length) override;
+
+		[[nodiscard]] const model::header& header() const { return m_header; }
+
+		/// \brief Decodes only the buffers of one LOD, with the three buffers decoded concurrently.
+		[[nodiscard]] lod_buffers read_lod(size_t lodIndex);
+
+	private:
+		size_t decode_blocks(std::span<const block_info_t> blocks, size_t skip, std::span<uint8_t> target);
 	};
 }
 
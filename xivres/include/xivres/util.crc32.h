@@ -0,0 +1,53 @@
+#ifndef XIVRES_INTERNAL_CRC32_H_
+#define XIVRES_INTERNAL_CRC32_H_
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace xivres::util {
+	namespace crc32_internal {
+		inline constexpr auto Table = [] {
+			std::array<uint32_t, 256> table{};
+			for (uint32_t i = 0; i < 256; ++i) {
+				auto c = i;
+				for (int j = 0; j < 8; ++j)
+					c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+				table[i] = c;
+			}
+			return table;
+		}();
+	}
+
+	// Same result as zlib's crc32(crc, data, size), but usable in constant expressions.
+	[[nodiscard]] constexpr uint32_t crc32_update(uint32_t crc, std::string_view data) {
+		crc = ~crc;
+		for (const auto c : data)
+			crc = crc32_internal::Table[(crc ^ static_cast<uint8_t>(c)) & 0xFF] ^ (crc >> 8);
+		return ~crc;
+	}
+
+	// As crc32_update, but hashes ASCII uppercase letters as lowercase and backslashes as slashes.
+	[[nodiscard]] constexpr uint32_t crc32_update_path(uint32_t crc, std::string_view data) {
+		crc = ~crc;
+		for (auto c : data) {
+			if ('A' <= c && c <= 'Z')
+				c = static_cast<char>(c - 'A' + 'a');
+			else if (c == '\\')
+				c = '/';
+			crc = crc32_internal::Table[(crc ^ static_cast<uint8_t>(c)) & 0xFF] ^ (crc >> 8);
+		}
+		return ~crc;
+	}
+
+	// Same result as crc32_update; uses table slicing, and carry-less multiplication on long inputs when available.
+	[[nodiscard]] uint32_t crc32_update_fast(uint32_t crc, std::span<const char> data);
+
+	// Computes what hashed_path::from would for each of paths: ASCII case and backslashes are folded.
+	// Empty paths get 0xFFFFFFFF everywhere; paths with a single part get 0xFFFFFFFF as their path hash.
+	// Output spans must be at least as long as paths. Like hashed_path::from, throws std::invalid_argument on non-ASCII input.
+	void crc32_hash_paths(std::span<const std::string_view> paths, std::span<uint32_t> pathHashes, std::span<uint32_t> nameHashes, std::span<uint32_t> fullPathHashes);
+}
+
+#endif
@@ -38,7 +38,7 @@ namespace xivres::util {
 		digest32_t m_digest;
 		uint8_t m_block[64];
 		size_t m_blockByteIndex;
-		size_t m_byteCount;
+		uint64_t m_byteCount;
 
 	public:
 		hash_sha1() {
@@ -79,50 +79,54 @@ namespace xivres::util {
 			++this->m_byteCount;
 			if (m_blockByteIndex == 64) {
 				this->m_blockByteIndex = 0;
-				process_block();
+				process_blocks(m_digest, m_block, 1);
 			}
 			return *this;
 		}
 
 		hash_sha1& process_block(const void* const start, const void* const end) {
-			auto begin = static_cast<const uint8_t*>(start);
-			const auto finish = static_cast<const uint8_t*>(end);
-			while (begin != finish) {
-				process_byte(*begin);
-				begin++;
-			}
-			return *this;
+			return process_bytes(start, static_cast<size_t>(static_cast<const uint8_t*>(end) - static_cast<const uint8_t*>(start)));
 		}
 
 		hash_sha1& process_bytes(const void* const data, size_t len) {
-			const auto block = static_cast<const uint8_t*>(data);
-			process_block(block, block + len);
+			auto ptr = static_cast<const uint8_t*>(data);
+			m_byteCount += len;
+
+			if (m_blockByteIndex) {
+				const auto available = (std::min)(len, sizeof m_block - m_blockByteIndex);
+				memcpy(&m_block[m_blockByteIndex], ptr, available);
+				m_blockByteIndex += available;
+				ptr += available;
+				len -= available;
+				if (m_blockByteIndex < sizeof m_block)
+					return *this;
+
+				process_blocks(m_digest, m_block, 1);
+				m_blockByteIndex = 0;
+			}
+
+			// Whole blocks are hashed straight from the input.
+			if (len >= sizeof m_block) {
+				process_blocks(m_digest, ptr, len / sizeof m_block);
+				ptr += len - len % sizeof m_block;
+				len %= sizeof m_block;
+			}
+
+			if (len) {
+				memcpy(m_block, ptr, len);
+				m_blockByteIndex = len;
+			}
 			return *this;
 		}
 
 		const uint32_t* get_digest(digest32_t digest) {
-			size_t bitCount = this->m_byteCount * 8;
-			process_byte(0x80);
-			if (this->m_blockByteIndex > 56) {
-				while (m_blockByteIndex != 0) {
-					process_byte(0);
-				}
-				while (m_blockByteIndex < 56) {
-					process_byte(0);
-				}
-			} else {
-				while (m_blockByteIndex < 56) {
-					process_byte(0);
-				}
-			}
-			process_byte(0);
-			process_byte(0);
-			process_byte(0);
-			process_byte(0);
-			process_byte(static_cast<unsigned char>((bitCount >> 24) & 0xFF));
-			process_byte(static_cast<unsigned char>((bitCount >> 16) & 0xFF));
-			process_byte(static_cast<unsigned char>((bitCount >> 8) & 0xFF));
-			process_byte(static_cast<unsigned char>((bitCount) & 0xFF));
+			const auto bitCount = m_byteCount * 8;
+
+			uint8_t padding[72]{ 0x80 };
+			const auto paddingLength = (m_blockByteIndex < 56 ? 56 : 120) - m_blockByteIndex;
+			for (size_t i = 0; i < 8; i++)
+				padding[paddingLength + i] = static_cast<uint8_t>(bitCount >> (56 - 8 * i));
+			process_bytes(padding, paddingLength + 8);
 
 			memcpy(digest, m_digest, 5 * sizeof(uint32_t));
 			return digest;
@@ -159,60 +163,9 @@ namespace xivres::util {
 			return digest;
 		}
 
-	private:
-		void process_block() {
-			uint32_t w[80];
-			for (size_t i = 0; i < 16; i++) {
-				w[i] = (m_block[i * 4 + 0] << 24);
-				w[i] |= (m_block[i * 4 + 1] << 16);
-				w[i] |= (m_block[i * 4 + 2] << 8);
-				w[i] |= (m_block[i * 4 + 3]);
-			}
-			for (size_t i = 16; i < 80; i++) {
-				w[i] = left_rotate((w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16]), 1);
-			}
-
-			uint32_t a = m_digest[0];
-			uint32_t b = m_digest[1];
-			uint32_t c = m_digest[2];
-			uint32_t d = m_digest[3];
-			uint32_t e = m_digest[4];
-
-			for (std::size_t i = 0; i < 80; ++i) {
-				uint32_t f;
-				uint32_t k;
-
-				if (i < 20) {
-					f = (b & c) | (~b & d);
-					k = 0x5A827999;
-				} else if (i < 40) {
-					f = b ^ c ^ d;
-					k = 0x6ED9EBA1;
-				} else if (i < 60) {
-					f = (b & c) | (b & d) | (c & d);
-					k = 0x8F1BBCDC;
-				} else {
-					f = b ^ c ^ d;
-					k = 0xCA62C1D6;
-				}
-				uint32_t temp = left_rotate(a, 5) + f + e + k + w[i];
-				e = d;
-				d = c;
-				c = left_rotate(b, 30);
-				b = a;
-				a = temp;
-			}
-
-			m_digest[0] += a;
-			m_digest[1] += b;
-			m_digest[2] += c;
-			m_digest[3] += d;
-			m_digest[4] += e;
-		}
-
-		static uint32_t left_rotate(uint32_t value, size_t count) {
-			return (value << count) ^ (value >> (32 - count));
-		}
+		/// \brief Runs the compression function over whole 64-byte blocks.
+		/// Uses the SHA extensions if the processor supports them.
+		static void process_blocks(digest32_t state, const uint8_t* data, size_t blockCount);
 	};
 }
 
@@ -1,10 +1,13 @@
 #ifndef XIVRES_INTERNAL_THREADPOOL_H_
 #define XIVRES_INTERNAL_THREADPOOL_H_
 
+#include <atomic>
+#include <bit>
 #include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <functional>
+#include <iosfwd>
 #include <future>
 #include <map>
 #include <mutex>
@@ -41,6 +44,11 @@ namespace xivres::util::thread_pool {
 		pool& m_pool;
 		bool m_bCancelled;
 
+	private:
+		// Keeps the task alive while it sits in a worker queue, which only stores raw pointers.
+		std::shared_ptr<base_task> m_pQueuedSelf;
+		std::chrono::steady_clock::time_point m_submittedAt;
+
 	public:
 		base_task(pool& pool)
 			: m_pool(pool)
@@ -152,10 +160,58 @@ namespace xivres::util::thread_pool {
 		}
 	};
 
+	/// \brief Pool of reusable objects.
+	///
+	/// Returned objects go to a cache slot picked by the returning thread, or to a shared lock-free freelist when the
+	/// slot is taken; checking out looks at the calling thread's slot first. As long as there are not many more threads
+	/// than slots, a thread mostly gets back the object it returned last, without touching memory shared with others.
 	template<typename T>
 	class object_pool {
-		std::mutex m_mutex;
-		std::vector<std::unique_ptr<T>> m_objects;
+		struct node {
+			std::unique_ptr<T> Object;
+			std::atomic<node*> Next = nullptr;
+		};
+
+		/// \brief Treiber stack; the upper 16 bits of the head hold a counter to avoid ABA.
+		/// Nodes are only freed when the pool goes away, so reading Next of a node that has just been popped by
+		/// someone else is safe; the counter makes the subsequent compare-exchange fail.
+		class node_stack {
+			static constexpr uint64_t PointerMask = (uint64_t{ 1 } << 48) - 1;
+			static constexpr uint64_t TagUnit = uint64_t{ 1 } << 48;
+
+			std::atomic_uint64_t m_head = 0;
+
+		public:
+			void push(node* pNode) {
+				auto head = m_head.load(std::memory_order_relaxed);
+				do {
+					pNode->Next.store(reinterpret_cast<node*>(head & PointerMask), std::memory_order_relaxed);
+				} while (!m_head.compare_exchange_weak(head, ((head & ~PointerMask) + TagUnit) | reinterpret_cast<uint64_t>(pNode), std::memory_order_release, std::memory_order_relaxed));
+			}
+
+			node* pop() {
+				auto head = m_head.load(std::memory_order_acquire);
+				while (true) {
+					const auto pNode = reinterpret_cast<node*>(head & PointerMask);
+					if (!pNode)
+						return nullptr;
+
+					const auto next = reinterpret_cast<uint64_t>(pNode->Next.load(std::memory_order_relaxed));
+					if (m_head.compare_exchange_weak(head, ((head & ~PointerMask) + TagUnit) | next, std::memory_order_acquire, std::memory_order_acquire))
+						return pNode;
+				}
+			}
+		};
+
+		struct alignas(64) cache_slot {
+			std::atomic<T*> Object = nullptr;
+		};
+
+		const size_t m_nSlotMask;
+		const std::unique_ptr<cache_slot[]> m_slots;
+		node_stack m_free;
+		node_stack m_spareNodes;
+		std::atomic_size_t m_nPooled = 0;  // only maintained if m_fnKeepCheck is set
 		std::function<bool(size_t, T&)> m_fnKeepCheck;
 
 	public:
@@ -166,38 +222,25 @@ namespace xivres::util::thread_pool {
 			friend class object_pool;
 
 			scoped_pooled_object(object_pool* parent)
-				: m_parent(parent) {
-
-				if (m_parent->m_objects.empty())
-					return;
-
-				const auto lock = std::lock_guard(m_parent->m_mutex);
-				if (m_parent->m_objects.empty())
-					return;
-
-				m_object = std::move(m_parent->m_objects.back());
-				m_parent->m_objects.pop_back();
+				: m_parent(parent)
+				, m_object(parent->take()) {
 			}
 
 		public:
 			scoped_pooled_object() : m_parent(nullptr) {}
 
 			scoped_pooled_object(scoped_pooled_object&& r) noexcept
-				: m_objects(std::move(r.m_object))
-				, m_parent(r.m_parent) {
+				: m_parent(r.m_parent)
+				, m_object(std::move(r.m_object)) {
 				r.m_parent = nullptr;
-				r.m_object.reset();
 			}
 
 			scoped_pooled_object& operator=(scoped_pooled_object&& r) noexcept {
 				if (this == &r)
 					return *this;
 
-				if (m_object && m_parent) {
-					const auto lock = std::lock_guard(m_parent->m_mutex);
-					if (!m_parent->m_fnKeepCheck || m_parent->m_fnKeepCheck(m_parent->m_objects.size(), *m_object))
-						m_parent->m_objects.emplace_back(std::move(m_object));
-				}
+				if (m_object && m_parent)
+					m_parent->put(std::move(m_object));
 
 				m_parent = r.m_parent;
 				m_object = std::move(r.m_object);
@@ -212,11 +255,8 @@ namespace xivres::util::thread_pool {
 			scoped_pooled_object& operator=(const scoped_pooled_object&) = delete;
 
 			~scoped_pooled_object() {
-				if (m_object && m_parent) {
-					const auto lock = std::lock_guard(m_parent->m_mutex);
-					if (!m_parent->m_fnKeepCheck || m_parent->m_fnKeepCheck(m_parent->m_objects.size(), *m_object))
-						m_parent->m_objects.emplace_back(std::move(m_object));
-				}
+				if (m_object && m_parent)
+					m_parent->put(std::move(m_object));
 			}
 
 			operator bool() const {
@@ -239,17 +279,72 @@ namespace xivres::util::thread_pool {
 		};
 
 		object_pool(std::function<bool(size_t, T&)> keepCheck = {})
-			: m_fnKeepCheck(std::move(keepCheck)) {
+			: m_nSlotMask(std::bit_ceil((std::max)(1U, std::thread::hardware_concurrency())) - 1)
+			, m_slots(std::make_unique<cache_slot[]>(m_nSlotMask + 1))
+			, m_fnKeepCheck(std::move(keepCheck)) {
 		}
 		object_pool(object_pool&&) = delete;
 		object_pool(const object_pool&) = delete;
 		object_pool& operator=(object_pool&&) = delete;
 		object_pool& operator=(const object_pool&) = delete;
-		~object_pool() = default;
+
+		~object_pool() {
+			for (size_t i = 0; i <= m_nSlotMask; i++)
+				delete m_slots[i].Object.load(std::memory_order_acquire);
+			while (const auto pNode = m_free.pop())
+				delete pNode;
+			while (const auto pNode = m_spareNodes.pop())
+				delete pNode;
+		}
 
 		scoped_pooled_object operator*() {
 			return { this };
 		}
+
+	private:
+		static size_t thread_slot_index() {
+			static std::atomic_size_t s_nextIndex = 0;
+			thread_local const auto t_index = s_nextIndex.fetch_add(1, std::memory_order_relaxed);
+			return t_index;
+		}
+
+		std::unique_ptr<T> take() {
+			auto& slot = m_slots[thread_slot_index() & m_nSlotMask];
+			auto pObject = slot.Object.load(std::memory_order_relaxed) ? slot.Object.exchange(nullptr, std::memory_order_acquire) : nullptr;
+
+			if (!pObject) {
+				const auto pNode = m_free.pop();
+				if (!pNode)
+					return nullptr;
+
+				pObject = pNode->Object.release();
+				m_spareNodes.push(pNode);
+			}
+
+			if (m_fnKeepCheck)
+				m_nPooled.fetch_sub(1, std::memory_order_relaxed);
+			return std::unique_ptr<T>(pObject);
+		}
+
+		void put(std::unique_ptr<T> pObject) {
+			if (m_fnKeepCheck) {
+				if (!m_fnKeepCheck(m_nPooled.load(std::memory_order_relaxed), *pObject))
+					return;
+				m_nPooled.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			auto& slot = m_slots[thread_slot_index() & m_nSlotMask];
+			if (T* expected = nullptr; slot.Object.compare_exchange_strong(expected, pObject.get(), std::memory_order_release, std::memory_order_relaxed)) {
+				pObject.release();
+				return;
+			}
+
+			auto pNode = m_spareNodes.pop();
+			if (!pNode)
+				pNode = new node();
+			pNode->Object = std::move(pObject);
+			m_free.push(pNode);
+		}
 	};
 
 	object_pool<std::vector<uint8_t>>::scoped_pooled_object pooled_byte_buffer();
@@ -260,29 +355,91 @@ namespace xivres::util::thread_pool {
 		}
 	};
 
+	/// \brief Histogram of durations, bucketed by powers of two nanoseconds.
+	struct latency_histogram {
+		// Bucket 0 holds durations under 1ns; bucket i holds durations in [2^(i-1), 2^i) ns; the last one holds the rest.
+		static constexpr size_t BucketCount = 48;
+
+		uint64_t Buckets[BucketCount]{};
+		uint64_t Count{};
+		std::chrono::nanoseconds Total{};
+		std::chrono::nanoseconds Max{};
+
+		static size_t bucket_index(std::chrono::nanoseconds duration);
+
+		void add(std::chrono::nanoseconds duration);
+
+		latency_histogram& operator+=(const latency_histogram& r);
+
+		[[nodiscard]] std::chrono::nanoseconds mean() const;
+
+		/// \brief Returns the upper bound of the bucket containing the given percentile.
+		/// \param percentile Value between 0 and 100.
+		[[nodiscard]] std::chrono::nanoseconds percentile(double percentile) const;
+	};
+
+	/// \brief Work-stealing thread pool.
+	///
+	/// Each worker owns a queue ordered by invoke path; tasks submitted from a worker go to its own queue, and tasks
+	/// submitted from elsewhere go to a shared injection queue with the same ordering. An idle worker looks at its own
+	/// queue first, then steals from the other workers, and then takes a batch from the injection queue, so that work
+	/// spawned by already running tasks is finished before unrelated work submitted later is started.
 	class pool {
 		friend class base_task;
 
-		struct thread_info {
-			std::thread Thread;
-			std::shared_ptr<base_task> Task;
-		};
-		std::map<std::thread::id, thread_info> m_mapThreads;
-		std::shared_ptr<std::shared_mutex> m_pmtxThread;
-		std::condition_variable_any m_cvThread;
-		size_t m_nConcurrency;
-		std::atomic_size_t m_nWaitingThreads;
-		size_t m_nFreeThreads;
-		bool m_bQuitting;
+		struct worker;
+
+		static constexpr size_t InjectionBatchSize = 8;
+
+		static thread_local worker* s_pCurrentWorker;
+
+		std::atomic<worker*> m_pWorkers;
+		std::shared_ptr<std::mutex> m_pmtxThread;
+		std::condition_variable m_cvThread;
+		size_t m_nThreads;
+		std::atomic_size_t m_nConcurrency;
+		std::atomic_size_t m_nActiveThreads;
+		std::atomic_size_t m_nIdleThreads;
+		std::atomic_size_t m_nSleepingThreads;
+		std::atomic_bool m_bQuitting;
 
 		std::chrono::nanoseconds m_durMaxThreadInactivity{ 5000000000LL };  // 5 seconds
 
-		uint64_t m_nTaskCounter = 0;
+		std::atomic_uint64_t m_nTaskCounter;
 		std::priority_queue<std::shared_ptr<base_task>, std::vector<std::shared_ptr<base_task>>, untyped_task_shared_ptr_comparator> m_pqTasks;
-		std::shared_ptr<std::mutex> m_pmtxTask;
-		std::condition_variable m_cvTask;
+		std::atomic_size_t m_nInjectedTasks;
+		std::mutex m_mtxTask;
+
+		std::mutex m_mtxIdle;
+		std::condition_variable m_cvIdle;
+
+		size_t m_nWorkerSlots;  // guarded by m_pmtxThread
+		uint64_t m_nSpawnedThreads;  // guarded by m_pmtxThread
+		uint64_t m_nRetiredThreads;  // guarded by m_pmtxThread
+		std::atomic_bool m_bTracing;
+		std::atomic<std::chrono::steady_clock::time_point> m_traceStartedAt;
 
 	public:
+		struct statistics {
+			size_t Concurrency{};
+			size_t Threads{};
+			size_t ActiveThreads{};
+			size_t IdleThreads{};
+			size_t QueuedTasks{};
+
+			uint64_t SubmittedTasks{};
+			uint64_t CompletedTasks{};
+			uint64_t StolenTasks{};
+			uint64_t SpawnedThreads{};
+			uint64_t RetiredThreads{};
+
+			// Time from submission until a worker started running the task.
+			latency_histogram WaitLatency;
+
+			// Time spent running the task, including the time spent in release_working_status.
+			latency_histogram RunLatency;
+		};
+
 		pool(size_t nConcurrentExecutions = (std::numeric_limits<size_t>::max)());
 
 		pool(pool&&) = delete;
@@ -303,7 +460,7 @@ namespace xivres::util::thread_pool {
 		template<class Rep, class Period>
 		void max_thread_inactivity(std::chrono::duration<Rep, Period> dur) {
 			m_durMaxThreadInactivity = dur;
-			m_cvTask.notify_all();
+			wake_all_workers();
 		}
 
 		std::chrono::nanoseconds max_thread_inactivity() const {
@@ -314,59 +471,51 @@ namespace xivres::util::thread_pool {
 
 		[[nodiscard]] size_t concurrency() const;
 
-		template<typename TReturn = void>
-		std::shared_ptr<task<TReturn>> submit(std::function<TReturn(task<TReturn>&)> fn) {
-			std::unique_lock lock(*m_pmtxTask);
+		/// \brief Takes a snapshot of the counters. Values are gathered without stopping the workers, and thus may be
+		/// slightly inconsistent with each other.
+		[[nodiscard]] statistics get_statistics() const;
 
-			auto pTask = std::make_shared<task<TReturn>>(*this, std::move(fn));
+		/// \brief Starts recording a trace event for every task that finishes from now on.
+		void begin_trace();
 
-			invoke_path_type& invokePath = pTask->m_invokePath;
-			if (const auto it = m_mapThreads.find(std::this_thread::get_id()); it != m_mapThreads.end())
-				invokePath = it->second.Task->m_invokePath;
-			invokePath.Stack[invokePath.Depth] = static_cast<uint16_t>(m_nTaskCounter++);
-			if (invokePath.Depth < invoke_path_type::StackSize)
-				++invokePath.Depth;
+		/// \brief Stops recording, and writes the recorded events in Chrome trace event format (chrome://tracing, Perfetto).
+		void end_trace(std::ostream& os);
 
-			m_pqTasks.emplace(pTask);
-			lock.unlock();
-
-			dispatch_task_to_worker();
+		template<typename TReturn = void>
+		std::shared_ptr<task<TReturn>> submit(std::function<TReturn(task<TReturn>&)> fn) {
+			auto pTask = std::make_shared<task<TReturn>>(*this, std::move(fn));
+			enqueue(pTask);
 			return pTask;
 		}
 
 		[[nodiscard]] on_dtor release_working_status();
 
 		template<typename TFn>
-		// ReSharper disable once CppNotAllPathsReturnValue
 		decltype(std::declval<TFn>()()) release_working_status(const TFn& fn) {
-			if (!current_task())
-				return fn();
-
-			m_nWaitingThreads += 1;
-			dispatch_task_to_worker();
-			if constexpr (std::is_same_v<decltype(fn()), void>) {
-				fn();
-				m_nWaitingThreads -= 1;
-			} else {
-				auto res = fn();
-				m_nWaitingThreads -= 1;
-				return res;
-			}
+			const auto releaser = release_working_status();
+			return fn();
 		}
 
 	private:
-		void worker_body();
+		void enqueue(std::shared_ptr<base_task> pTask);
+
+		void worker_body(worker& self);
 
 		void dispatch_task_to_worker();
 
-		bool take_task(std::shared_ptr<base_task>& pTask) {
-			if (m_mapThreads.size() - m_nWaitingThreads >= m_nConcurrency || m_pqTasks.empty())
-				return false;
+		void spawn_worker();
 
-			pTask = std::move(const_cast<std::shared_ptr<base_task>&>(m_pqTasks.top()));
-			m_pqTasks.pop();
-			return true;
-		}
+		void wake_all_workers();
+
+		[[nodiscard]] bool try_reserve_active_slot();
+
+		[[nodiscard]] bool has_queued_tasks() const;
+
+		[[nodiscard]] bool take_task(worker& self, std::shared_ptr<base_task>& pTask);
+
+		[[nodiscard]] bool take_injected_tasks(worker& self, std::shared_ptr<base_task>& pTask);
+
+		[[nodiscard]] bool wait_for_work(std::chrono::steady_clock::time_point deadline);
 	};
 
 	template<typename TFn>
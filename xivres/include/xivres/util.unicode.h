@@ -2,6 +2,7 @@
 #define XIVRES_UNICODE_H_
 
 #include <cstdint>
+#include <limits>
 #include <span>
 #include <string>
 
@@ -39,6 +40,17 @@ namespace xivres::util::unicode {
 		return encode(EncodingTag<T>(), ptr, c, strict);
 	}
 
+	// Counts leading units below U+0080, which decode to a single codepoint of the same value in every supported encoding.
+	size_t count_leading_ascii(const char8_t* in, size_t count);
+	size_t count_leading_ascii(const char16_t* in, size_t count);
+	size_t count_leading_ascii(const char32_t* in, size_t count);
+	size_t count_leading_ascii(const char* in, size_t count);
+	size_t count_leading_ascii(const wchar_t* in, size_t count);
+
+	// Checks for well-formed UTF-8 as defined by RFC 3629; overlong forms, surrogates and codepoints past U+10FFFF are rejected.
+	bool is_valid_utf8(std::u8string_view in);
+	bool is_valid_utf8(std::string_view in);
+
 	template<class TTo>
 	TTo& convert_from_codepoint(TTo& out, char32_t c, bool strict = false) {
 		const auto encLen = encode<typename TTo::value_type>(nullptr, c, strict);
@@ -105,7 +117,24 @@ namespace xivres::util::unicode {
 		out.reserve(out.size() + in.size() * 4 / sizeof(in[0]) / sizeof(out[0]));
 
 		char32_t c{};
-		for (size_t decLen = 0, decIdx = 0; decIdx < in.size() && ((decLen = decode(c, &in[decIdx], in.size() - decIdx, strict))); decIdx += decLen) {
+		for (size_t decLen = 0, decIdx = 0; decIdx < in.size(); decIdx += decLen) {
+			if (const auto asciiLen = count_leading_ascii(&in[decIdx], in.size() - decIdx)) {
+				// Copy as-is, stopping early if pfnCharMap maps a character outside ASCII.
+				const auto encIdx = out.size();
+				out.resize(encIdx + asciiLen);
+				for (decLen = 0; decLen < asciiLen; ++decLen) {
+					c = static_cast<char32_t>(in[decIdx + decLen]);
+					if (pfnCharMap && (c = pfnCharMap(c)) >= 0x80)
+						break;
+					out[encIdx + decLen] = static_cast<typename TTo::value_type>(c);
+				}
+				out.resize(encIdx + decLen);
+				if (decLen)
+					continue;
+			}
+
+			if (!((decLen = decode(c, &in[decIdx], in.size() - decIdx, strict))))
+				break;
 			if (pfnCharMap)
 				c = pfnCharMap(c);
 			
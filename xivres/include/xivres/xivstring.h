@@ -367,6 +367,81 @@ namespace xivres {
 		[[nodiscard]] std::unique_ptr<xivexpr> clone() const override { return std::make_unique<std::remove_cvref_t<decltype(*this)>>(*this); }
 		[[nodiscard]] std::string repr() const override;
 	};
+
+	// Non-owning view over an escaped xivstring; payloads are located only while iterating.
+	class xivstring_view {
+		std::string_view m_escaped;
+
+	public:
+		struct segment {
+			bool IsPayload = false;
+			xivstring::xivpayload_type PayloadType = xivstring::xivpayload_type::Unset;
+
+			// Raw bytes of this segment; includes STX and ETX for payloads.
+			std::string_view Escaped;
+
+			// Text for text segments, or the encoded expressions for payloads.
+			std::string_view Body;
+
+			[[nodiscard]] xivstring::xivpayload to_payload() const;
+		};
+
+		class iterator {
+			std::string_view m_remaining;
+			segment m_current;
+
+			void read_next();
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = segment;
+			using difference_type = ptrdiff_t;
+			using pointer = const segment*;
+			using reference = const segment&;
+
+			iterator() = default;
+			explicit iterator(std::string_view escaped);
+
+			reference operator*() const { return m_current; }
+			pointer operator->() const { return &m_current; }
+
+			iterator& operator++() {
+				read_next();
+				return *this;
+			}
+
+			iterator operator++(int) {
+				auto prev = *this;
+				read_next();
+				return prev;
+			}
+
+			bool operator==(const iterator& r) const {
+				return m_current.Escaped.data() == r.m_current.Escaped.data();
+			}
+		};
+
+		xivstring_view() = default;
+		xivstring_view(std::string_view escaped) : m_escaped(escaped) {}
+		xivstring_view(const std::string& escaped) : m_escaped(escaped) {}
+		xivstring_view(const xivstring& s) : m_escaped(s.escaped()) {}
+
+		auto operator<=>(const xivstring_view& r) const = default;
+
+		[[nodiscard]] std::string_view escaped() const { return m_escaped; }
+		[[nodiscard]] bool empty() const { return m_escaped.empty(); }
+		[[nodiscard]] size_t size() const { return m_escaped.size(); }
+
+		[[nodiscard]] iterator begin() const { return iterator(m_escaped); }
+		[[nodiscard]] iterator end() const { return {}; }
+
+		[[nodiscard]] bool has_payload() const { return m_escaped.find(xivstring::StartOfText) != std::string_view::npos; }
+
+		// Concatenates text segments, dropping payloads.
+		[[nodiscard]] std::string text() const;
+
+		[[nodiscard]] xivstring to_xivstring() const { return xivstring(std::string(m_escaped)); }
+	};
 }
 
 #endif